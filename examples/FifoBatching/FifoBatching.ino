@@ -0,0 +1,72 @@
+#include <Arduino.h>
+#include <BMA400.h>
+#include <Wire.h>
+
+#define FIFO_INT_PIN GPIO_NUM_37
+#define MAX_SAMPLES 256
+BMA400 bma400;
+
+bool newInterrupt;
+int16_t samples[MAX_SAMPLES * 3];
+portMUX_TYPE fifoInterruptPinMux = portMUX_INITIALIZER_UNLOCKED;
+void IRAM_ATTR handleFifoExternalInterrupt()
+{
+  portENTER_CRITICAL_ISR(&fifoInterruptPinMux);
+  newInterrupt = true;
+  portEXIT_CRITICAL_ISR(&fifoInterruptPinMux);
+}
+
+void setup()
+{
+  // put your setup code here, to run once:
+  Serial.begin(115200);
+
+  pinMode(FIFO_INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(FIFO_INT_PIN), handleFifoExternalInterrupt, FALLING);
+
+  Wire1.begin(GPIO_NUM_21, GPIO_NUM_22, 400000);
+
+  if (bma400.Initialize(Wire1)) // Using user defined (Wire1) interface & automatically resolving the address
+  {
+    printf("BMA400 Sensor successfully found\r\n");
+
+    bma400.Setup(
+        BMA400::power_mode_t::NORMAL,
+        BMA400::output_data_rate_t::Filter1_048x_100Hz,
+        BMA400::acceleation_range_t::RANGE_2G);
+
+    bma400.DisableInterrupts(); // disables all interrupts if previously set
+
+    uint16_t batch = bma400.ConfigureFifoBatching(
+        1000,                              // wake up at most once per second
+        20,                                // 20mg resolution is enough, allows 8 bit frames
+        BMA400::interrupt_pin_t::INT_PIN_1 // Link FIFO watermark to INT Pin 1
+    );
+    printf("Samples per batch: %d\r\n", batch);
+
+    bma400.ConfigureInterruptPinSettings(
+        false, // Disable Latch
+        false, // Interrupt Pin 1 active low
+        false, // Interrupt Pin 1 in push-pull mode
+        false, // Interrupt Pin 2 active low
+        false  // Interrupt Pin 2 in push-pull mode
+    );
+
+    while (bma400.GetInterrupts()) // make sure there is no interrupt on the queue
+      ;
+  }
+  else
+    printf("Error! no BMA400 sensor found\r\n");
+}
+
+void loop()
+{
+  if (newInterrupt)
+  {
+    newInterrupt = false;
+    uint16_t count = bma400.ReadFifo(samples, MAX_SAMPLES);
+    if (count > 0) // nothing read on a spurious edge or a bus error
+      printf("%d samples. Last [X, Y, Z] = %d %d %d\r\n", count,
+             samples[(count - 1) * 3], samples[(count - 1) * 3 + 1], samples[(count - 1) * 3 + 2]);
+  }
+}
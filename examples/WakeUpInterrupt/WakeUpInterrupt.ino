@@ -0,0 +1,79 @@
+#include <Arduino.h>
+#include <BMA400.h>
+#include <Wire.h>
+
+#define WAKEUP_INT_PIN GPIO_NUM_37
+BMA400 bma400;
+
+bool newInterrupt;
+portMUX_TYPE wakeupInterruptPinMux = portMUX_INITIALIZER_UNLOCKED;
+void IRAM_ATTR handleWakeupExternalInterrupt()
+{
+  portENTER_CRITICAL_ISR(&wakeupInterruptPinMux);
+  newInterrupt = true;
+  portEXIT_CRITICAL_ISR(&wakeupInterruptPinMux);
+}
+
+void setup()
+{
+  // put your setup code here, to run once:
+  Serial.begin(115200);
+
+  pinMode(WAKEUP_INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(WAKEUP_INT_PIN), handleWakeupExternalInterrupt, FALLING);
+
+  Wire1.begin(GPIO_NUM_21, GPIO_NUM_22, 400000);
+
+  if (bma400.Initialize(Wire1)) // Using user defined (Wire1) interface & automatically resolving the address
+  {
+    printf("BMA400 Sensor successfully found\r\n");
+
+    bma400.Setup(
+        BMA400::power_mode_t::LOWEST_POWER_WITH_NOISE, // 0.85uA while waiting for motion
+        BMA400::output_data_rate_t::Filter1_048x_100Hz,
+        BMA400::acceleation_range_t::RANGE_2G);
+
+    bma400.DisableInterrupts(); // disables all interrupts if previously set
+
+    bma400.ConfigureWakeupInterrupt(
+        true,                                                        // Enable Interrupt
+        BMA400::interrupt_pin_t::INT_PIN_1,                          // Link to INT Pin 1
+        BMA400::wakeup_reference_update_t::WAKEUP_UPDATE_EVERYTIME,  // Update reference values automatically in low power mode
+        (float)100,                                                  // 100mg
+        2,                                                           // 2 consecutive samples above threshold
+        true,                                                        // Monitor X Axis
+        true,                                                        // Monitor Y Axis
+        true                                                         // Monitor Z Axis
+    );
+
+    bma400.ConfigureAutoLowPower(
+        false,                                                      // Not on Data Ready
+        false,                                                      // Not on Generic Interrupt 1
+        BMA400::auto_low_power_timeout_mode_t::ON_TIMEOUT,          // Go back to low power after timeout
+        (float)5000                                                 // 5 seconds after waking up
+    );
+
+    bma400.ConfigureInterruptPinSettings(
+        false, // Disable Latch
+        false, // Interrupt Pin 1 active low
+        false, // Interrupt Pin 1 in push-pull mode
+        false, // Interrupt Pin 2 active low
+        false  // Interrupt Pin 2 in push-pull mode
+    );
+
+    while (bma400.GetInterrupts()) // make sure there is no interrupt on the queue
+      ;
+  }
+  else
+    printf("Error! no BMA400 sensor found\r\n");
+}
+
+void loop()
+{
+  if (newInterrupt)
+  {
+    if (bma400.GetInterrupts() & BMA400::interrupt_source_t::BAS_WAKEUP)
+      printf("Woke up on motion.\r\n");
+    newInterrupt = false;
+  }
+}
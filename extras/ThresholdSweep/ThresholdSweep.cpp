@@ -0,0 +1,415 @@
+/*!
+ * @file ThresholdSweep.cpp
+ *
+ *  @section Information
+ *
+ *  Host tool (not part of the Arduino library build) for choosing the arguments of
+ *  BMA400::ConfigureGenericInterrupt and BMA400::ConfigureActivityChangeInterrupt from
+ *  labelled recordings instead of picking them by hand.
+ *
+ *  Every candidate configuration is replayed through a software model of the interrupt
+ *  engine and scored by precision, recall and the resulting wake-up rate. The search is
+ *  spread over all available cores.
+ *
+ *  Durations and observation windows are swept in samples of --odr, so the printed calls
+ *  use ACC_FILT_1 (the configured data rate); set the same data rate on the sensor.
+ *
+ *  The tap engine (tap_sensitivity_level_t, tap_max_pick_to_pick_interval_t) is not swept:
+ *  its detection algorithm is not documented by Bosch and cannot be modelled faithfully.
+ *
+ *  Build:  g++ -std=c++11 -O2 -pthread ThresholdSweep.cpp -o ThresholdSweep
+ *
+ *  Usage:  ThresholdSweep [options] recording.csv [recording.csv ...]
+ *
+ *  Each recording holds one sample per line as "x,y,z,label" where x, y and z are the raw
+ *  values returned by ReadAcceleration(int16_t *) and label is 1 while the event that should
+ *  wake the MCU is happening and 0 otherwise. Lines starting with '#' are ignored.
+ *
+ *  Options:
+ *    --odr <Hz>                  data rate the recordings were taken at (default 100)
+ *    --range <2|4|8|16>          range the recordings were taken at (default 2)
+ *    --mode <activity|inactivity> generic interrupt mode to sweep (default activity)
+ *    --reference <manual|everytime> reference update mode (default everytime)
+ *    --max-wakeups <n>           upper bound for wake-ups per hour (default unlimited)
+ *    --beta <f>                  weight of recall against precision in the F score (default 1)
+ *    --tolerance-ms <ms>         late detections still counted as hits (default 0)
+ *    --top <n>                   number of configurations printed (default 5)
+ *    --threads <n>               worker threads (default: all cores)
+ *
+ *  @section author Author
+ *
+ *  MReza Naeemabadi
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Recording
+    {
+        std::string name;
+        std::vector<float> x, y, z; // in mg
+        std::vector<bool> label;
+    };
+
+    enum Engine
+    {
+        GENERIC_INTERRUPT,
+        ACTIVITY_CHANGE
+    };
+
+    struct Candidate
+    {
+        Engine engine;
+        uint8_t threshold;   // 1 LSB = 8mg for both engines
+        uint16_t duration;   // samples (generic interrupt only)
+        uint8_t hysteresis;  // generic_interrupt_hysteresis_amplitude_t
+        bool all_combined;   // generic interrupt only
+        uint8_t observation; // activity_change_observation_number_t
+    };
+
+    struct Score
+    {
+        uint32_t events;
+        uint32_t detected;
+        uint32_t false_wakeups;
+        uint32_t wakeups;
+        double precision;
+        double recall;
+        double f_score;
+        double wakeups_per_hour;
+    };
+
+    struct Options
+    {
+        float odr = 100;
+        int range = 2;
+        bool inactivity = false;
+        bool everytime_reference = true;
+        double max_wakeups = -1;
+        double beta = 1;
+        float tolerance_ms = 0;
+        int top = 5;
+        unsigned threads = 0;
+    };
+
+    const float hysteresis_mg[] = {0, 24, 48, 96};
+    const char *hysteresis_names[] = {"AMP_0mg", "AMP_24mg", "AMP_48mg", "AMP_96mg"};
+    const char *observation_names[] = {"OBSERVATION_32", "OBSERVATION_64", "OBSERVATION_128", "OBSERVATION_256", "OBSERVATION_512"};
+    const uint16_t duration_ms[] = {0, 10, 20, 40, 60, 80, 100, 150, 200, 300, 500, 1000, 2000};
+
+    bool load(const char *path, float lsb_per_mg, Recording &recording)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        recording.name = path;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::replace(line.begin(), line.end(), ',', ' ');
+            std::istringstream fields(line);
+            int x, y, z, label;
+            if (!(fields >> x >> y >> z >> label))
+                continue;
+            recording.x.push_back(x / lsb_per_mg);
+            recording.y.push_back(y / lsb_per_mg);
+            recording.z.push_back(z / lsb_per_mg);
+            recording.label.push_back(label != 0);
+        }
+        return !recording.x.empty();
+    }
+
+    //# Returns the sample indices where the modelled interrupt is asserted (rising edges)
+    void simulateGeneric(const Candidate &c, const Options &options, const Recording &r, std::vector<size_t> &edges)
+    {
+        const float threshold = c.threshold * 8.0f;
+        const float release = threshold - hysteresis_mg[c.hysteresis];
+        float ref[3] = {r.x[0], r.y[0], r.z[0]};
+        uint32_t hold = 0;
+        bool asserted = false;
+
+        for (size_t i = 0; i < r.x.size(); i++)
+        {
+            float delta[3] = {std::fabs(r.x[i] - ref[0]), std::fabs(r.y[i] - ref[1]), std::fabs(r.z[i] - ref[2])};
+            bool any = false, all = true, release_any = false, release_all = true;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                bool hit = options.inactivity ? delta[axis] < threshold : delta[axis] > threshold;
+                bool hold_on = options.inactivity ? delta[axis] < threshold + hysteresis_mg[c.hysteresis] : delta[axis] > release;
+                any |= hit;
+                all &= hit;
+                release_any |= hold_on;
+                release_all &= hold_on;
+            }
+
+            if (!asserted)
+            {
+                hold = (c.all_combined ? all : any) ? hold + 1 : 0;
+                if (hold > c.duration)
+                {
+                    asserted = true;
+                    edges.push_back(i);
+                }
+            }
+            else if (!(c.all_combined ? release_all : release_any))
+            {
+                asserted = false;
+                hold = 0;
+                if (options.everytime_reference)
+                {
+                    ref[0] = r.x[i];
+                    ref[1] = r.y[i];
+                    ref[2] = r.z[i];
+                }
+            }
+        }
+    }
+
+    void simulateActivityChange(const Candidate &c, const Recording &r, std::vector<size_t> &edges)
+    {
+        const size_t window = 32u << c.observation;
+        const float threshold = c.threshold * 8.0f;
+        float previous[3] = {0};
+        bool has_previous = false;
+
+        for (size_t start = 0; start + window <= r.x.size(); start += window)
+        {
+            float mean[3] = {0};
+            for (size_t i = start; i < start + window; i++)
+            {
+                mean[0] += r.x[i];
+                mean[1] += r.y[i];
+                mean[2] += r.z[i];
+            }
+            bool changed = false;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                mean[axis] /= window;
+                changed |= has_previous && std::fabs(mean[axis] - previous[axis]) > threshold;
+                previous[axis] = mean[axis];
+            }
+            has_previous = true;
+            if (changed)
+                edges.push_back(start + window - 1);
+        }
+    }
+
+    Score evaluate(const Candidate &c, const Options &options, const std::vector<Recording> &recordings)
+    {
+        Score score = {};
+        double samples = 0;
+        const size_t tolerance = (size_t)(options.tolerance_ms * options.odr / 1000.0f);
+        std::vector<size_t> edges;
+
+        for (const Recording &r : recordings)
+        {
+            edges.clear();
+            if (c.engine == GENERIC_INTERRUPT)
+                simulateGeneric(c, options, r, edges);
+            else
+                simulateActivityChange(c, r, edges);
+
+            samples += r.x.size();
+            score.wakeups += edges.size();
+
+            //# walking through labelled events and matching the edges against them
+            size_t e = 0;
+            for (size_t i = 0; i < r.label.size();)
+            {
+                if (!r.label[i])
+                {
+                    i++;
+                    continue;
+                }
+                size_t begin = i;
+                while (i < r.label.size() && r.label[i])
+                    i++;
+                size_t end = i + tolerance;
+
+                score.events++;
+                while (e < edges.size() && edges[e] < begin)
+                {
+                    score.false_wakeups++;
+                    e++;
+                }
+                if (e < edges.size() && edges[e] < end)
+                    score.detected++;
+                while (e < edges.size() && edges[e] < end)
+                    e++;
+            }
+            score.false_wakeups += edges.size() - e;
+        }
+
+        uint32_t hits = score.detected + score.false_wakeups;
+        score.precision = hits ? (double)score.detected / hits : 0;
+        score.recall = score.events ? (double)score.detected / score.events : 0;
+        double b2 = options.beta * options.beta;
+        double denominator = b2 * score.precision + score.recall;
+        score.f_score = denominator > 0 ? (1 + b2) * score.precision * score.recall / denominator : 0;
+        score.wakeups_per_hour = score.wakeups * 3600.0 * options.odr / samples;
+        return score;
+    }
+
+    void candidates(const Options &options, std::vector<Candidate> &list)
+    {
+        for (uint16_t threshold = 1; threshold <= 255; threshold++)
+        {
+            for (uint16_t ms : duration_ms)
+                for (uint8_t hysteresis = 0; hysteresis < 4; hysteresis++)
+                    for (int combined = 0; combined < 2; combined++)
+                        list.push_back({GENERIC_INTERRUPT, (uint8_t)threshold,
+                                        (uint16_t)std::lround(ms * options.odr / 1000.0f),
+                                        hysteresis, combined == 1, 0});
+
+            for (uint8_t observation = 0; observation < 5; observation++)
+                list.push_back({ACTIVITY_CHANGE, (uint8_t)threshold, 0, 0, false, observation});
+        }
+    }
+
+    void print(const Candidate &c, const Score &s, const Options &options)
+    {
+        printf("F=%.3f precision=%.3f recall=%.3f (%u/%u events) wake-ups/h=%.1f false=%u\n",
+               s.f_score, s.precision, s.recall, s.detected, s.events, s.wakeups_per_hour, s.false_wakeups);
+        if (c.engine == GENERIC_INTERRUPT)
+            printf("  bma400.ConfigureGenericInterrupt(\n"
+                   "      BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1, true, BMA400::interrupt_pin_t::INT_PIN_1,\n"
+                   "      BMA400::generic_interrupt_reference_update_t::%s,\n"
+                   "      BMA400::generic_interrupt_mode_t::%s,\n"
+                   "      (uint8_t)%u, (uint16_t)%u, // %.0f mg, %.1f ms\n"
+                   "      BMA400::generic_interrupt_hysteresis_amplitude_t::%s,\n"
+                   "      BMA400::interrupt_data_source_t::ACC_FILT_1, true, true, true, %s, true);\n",
+                   options.everytime_reference ? "EVERYTIME_UPDATE_FROM_ACC_FILTx" : "MANUAL_UPDATE",
+                   options.inactivity ? "INACTIVITY_DETECTION" : "ACTIVITY_DETECTION",
+                   c.threshold, c.duration, c.threshold * 8.0f, c.duration * 1000.0f / options.odr,
+                   hysteresis_names[c.hysteresis], c.all_combined ? "true" : "false");
+        else
+            printf("  bma400.ConfigureActivityChangeInterrupt(\n"
+                   "      true, BMA400::interrupt_pin_t::INT_PIN_1, (uint8_t)%u, // %.0f mg\n"
+                   "      BMA400::activity_change_observation_number_t::%s, // %.1f ms\n"
+                   "      BMA400::interrupt_data_source_t::ACC_FILT_1);\n",
+                   c.threshold, c.threshold * 8.0f, observation_names[c.observation],
+                   (32u << c.observation) * 1000.0f / options.odr);
+    }
+
+    void usage()
+    {
+        fprintf(stderr, "usage: ThresholdSweep [--odr Hz] [--range g] [--mode activity|inactivity] "
+                        "[--reference manual|everytime] [--max-wakeups n] [--beta f] [--tolerance-ms ms] "
+                        "[--top n] [--threads n] recording.csv [...]\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    std::vector<const char *> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--odr") && has_value)
+            options.odr = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--range") && has_value)
+            options.range = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--mode") && has_value)
+            options.inactivity = !strcmp(argv[++i], "inactivity");
+        else if (!strcmp(argv[i], "--reference") && has_value)
+            options.everytime_reference = strcmp(argv[++i], "manual") != 0;
+        else if (!strcmp(argv[i], "--max-wakeups") && has_value)
+            options.max_wakeups = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--beta") && has_value)
+            options.beta = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--tolerance-ms") && has_value)
+            options.tolerance_ms = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--top") && has_value)
+            options.top = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && has_value)
+            options.threads = (unsigned)atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+        {
+            usage();
+            return 1;
+        }
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (paths.empty() || options.odr <= 0 || (options.range != 2 && options.range != 4 && options.range != 8 && options.range != 16))
+    {
+        usage();
+        return 1;
+    }
+
+    //# 12 bit data: 1024 LSB/g at 2G down to 128 LSB/g at 16G
+    const float lsb_per_mg = 2048.0f / options.range / 1000.0f;
+    std::vector<Recording> recordings(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+        if (!load(paths[i], lsb_per_mg, recordings[i]))
+        {
+            fprintf(stderr, "Error! cannot read samples from %s\n", paths[i]);
+            return 1;
+        }
+
+    std::vector<Candidate> list;
+    candidates(options, list);
+    std::vector<Score> scores(list.size());
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&]()
+                             {
+                                 for (size_t i = next++; i < list.size(); i = next++)
+                                     scores[i] = evaluate(list[i], options, recordings);
+                             });
+    for (std::thread &worker : workers)
+        worker.join();
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < list.size(); i++)
+        if (options.max_wakeups < 0 || scores[i].wakeups_per_hour <= options.max_wakeups)
+            order.push_back(i);
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+              {
+                  if (scores[a].f_score != scores[b].f_score)
+                      return scores[a].f_score > scores[b].f_score;
+                  return scores[a].wakeups_per_hour < scores[b].wakeups_per_hour;
+              });
+
+    if (order.empty())
+    {
+        printf("No configuration stays below %.1f wake-ups per hour\n", options.max_wakeups);
+        return 2;
+    }
+
+    printf("%zu configurations evaluated on %u threads\n\n", list.size(), threads);
+    for (size_t i = 0; i < order.size() && i < (size_t)options.top; i++)
+    {
+        print(list[order[i]], scores[order[i]], options);
+        printf("\n");
+    }
+    return 0;
+}
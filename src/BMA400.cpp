@@ -21,7 +21,34 @@
  */
 
 #include <BMA400.h>
+#include <BMA400Mux.h>
 
+//# frequency and bandwidth (Hz) in order of output_data_rate_t
+static const struct
+{
+    float frequency;
+    float bandwidth;
+} BMA400_RATES[] = {
+    {100, 48}, //# UNKNOWN_RATE, same as the power-on default
+    {800, 384},
+    {800, 192},
+    {400, 192},
+    {400, 96},
+    {200, 96},
+    {200, 48},
+    {100, 48},
+    {100, 24},
+    {50, 24},
+    {50, 12},
+    {25, 12},
+    {25, 6},
+    {12.5, 6},
+    {12.5, 3},
+    {100, 48},
+    {100, 1},
+};
+
+#if defined(ARDUINO)
 /*!
  *  @brief  Initializing the libary with auto address detect
  *  @param  _wire TwoWire interface - defalt Wire
@@ -30,11 +57,16 @@
 bool BMA400::Initialize(TwoWire &_wire)
 {
     wire = &_wire;
+    bus = nullptr;
+    mux = nullptr;
+    rate_descriptor_valid = false;
+    activity = activity_t::ACTIVITY_STILL;
     address = BMA400_ADDRESS_PRIMARY;
 
     if (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID)
         return true;
     address = BMA400_ADDRESS_SECONDARY;
+    GetLastBusStatus(); //# probing the primary address is expected to fail
 
     return (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID);
 }
@@ -48,1615 +80,3677 @@ bool BMA400::Initialize(TwoWire &_wire)
 bool BMA400::Initialize(uint8_t _address, TwoWire &_wire)
 {
     wire = &_wire;
+    bus = nullptr;
+    mux = nullptr;
+    rate_descriptor_valid = false;
+    activity = activity_t::ACTIVITY_STILL;
     address = _address;
     return (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID);
 }
+#endif
 
 /*!
- *  @brief  Quick Stepup for BMA400
- *  @param  mode power mode see power_mode_t for more details
- *  @param  rate data rate select one between 16 rates. see output_data_rate_t for more details
- *  @param  range sampling range 2, 4, 8, 16G. Use acceleation_range_t data type
+ *  @brief  Initializing the libary with auto address detect using a custom transport
+ *  @param  _bus transport implementing BMA400Interface (e.g. BMA400LinuxI2C)
+ *  @return true if any BMA400 sensor found
  */
-void BMA400::Setup(const power_mode_t &mode, output_data_rate_t rate, acceleation_range_t range)
+bool BMA400::Initialize(BMA400Interface &_bus)
 {
-    SetPowerMode(mode);
-    SetRange(range);
-    SetDataRate(rate);
+    bus = &_bus;
+    mux = nullptr;
+    rate_descriptor_valid = false;
+    activity = activity_t::ACTIVITY_STILL;
+    address = BMA400_ADDRESS_PRIMARY;
+
+    if (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID)
+        return true;
+    address = BMA400_ADDRESS_SECONDARY;
+    GetLastBusStatus(); //# probing the primary address is expected to fail
+
+    return (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID);
 }
 
 /*!
- *  @brief  Runs command
- *  @param  cmd check command_t for more details
- *  @return true if command is sent successfully
+ *  @brief  Initializing the libary using sensor address and a custom transport
+ *  @param  _address sensor address
+ *  @param  _bus transport implementing BMA400Interface (e.g. BMA400LinuxI2C)
+ *  @return true if sensor found
  */
-bool BMA400::ExecuteCommand(command_t cmd)
+bool BMA400::Initialize(uint8_t _address, BMA400Interface &_bus)
 {
-    if ((read(BMA400_REG_STATUS) & 0x10) != 0x10)
-        return false;
-
-    write(BMA400_REG_COMMAND, cmd);
-    return true;
+    bus = &_bus;
+    mux = nullptr;
+    rate_descriptor_valid = false;
+    activity = activity_t::ACTIVITY_STILL;
+    address = _address;
+    return (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID);
 }
 
 /*!
- *  @brief  Getting current power mode (9 modes) includes Sleep/Low/Normal and 4 level of noise performance
- *  @return power mode. see power_mode_t for more details
+ *  @brief  Initializing the libary with auto address detect for a sensor behind an I2C mux
+ *  @param  _mux mux the sensor is connected to (started with BMA400Mux::Begin)
+ *  @param  channel mux channel (0 - 7)
+ *  @return true if any BMA400 sensor found
  */
-BMA400::power_mode_t BMA400::GetPowerMode()
+bool BMA400::Initialize(BMA400Mux &_mux, uint8_t channel)
 {
-
-    switch (read(BMA400_REG_ACC_CONFIG_0) & 0x03)
+    if (!Initialize(BMA400_ADDRESS_PRIMARY, _mux, channel))
     {
-    case 0:
-    case 3:
-        return power_mode_t::SLEEP;
-
-    case 1: //# Low Power
-        switch ((read(BMA400_REG_ACC_CONFIG_0) >> 5) & 0x03)
-        {
-        case 0:
-            return power_mode_t::LOWEST_POWER_WITH_NOISE;
-        case 1:
-            return power_mode_t::ULTRA_LOW_POWER;
-        case 2:
-            return power_mode_t::LOW_POWER;
-        case 3:
-            return power_mode_t::LOW_POWER_LOW_NOISE;
-        default:
-            return power_mode_t::UNKNOWN_MODE;
-        }
-        break;
-
-    case 2:
-        switch ((read(BMA400_REG_ACC_CONFIG_1) >> 4) & 0x03)
-        {
-        case 0:
-            return power_mode_t::NORMAL_LOWER_POWER_WITH_NOISE;
-        case 1:
-            return power_mode_t::NORMAL;
-        case 2:
-            return power_mode_t::NORMAL_LOW_NOISE;
-        case 3:
-            return power_mode_t::NORMAL_LOWEST_NOISE;
-
-        default:
-            return power_mode_t::UNKNOWN_MODE;
-        }
-        break;
-
-    default:
-        return power_mode_t::UNKNOWN_MODE;
+        address = BMA400_ADDRESS_SECONDARY;
+        GetLastBusStatus(); //# probing the primary address is expected to fail
+        return (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID);
     }
-    return power_mode_t::UNKNOWN_MODE;
+    return true;
 }
 
 /*!
- *  @brief  Updating the power mode 
- *  @param  mode power mode see power_mode_t for more details
+ *  @brief  Initializing the libary using sensor address for a sensor behind an I2C mux.
+ *          The channel is selected before every transaction (only written when it changes)
+ *  @param  _address sensor address
+ *  @param  _mux mux the sensor is connected to (started with BMA400Mux::Begin)
+ *  @param  channel mux channel (0 - 7)
+ *  @return true if sensor found
  */
-void BMA400::SetPowerMode(const power_mode_t &mode)
+bool BMA400::Initialize(uint8_t _address, BMA400Mux &_mux, uint8_t channel)
 {
-    uint8_t config = read(BMA400_REG_ACC_CONFIG_0);
-
-    switch (mode)
-    {
-    case power_mode_t::SLEEP:
-        write(BMA400_REG_ACC_CONFIG_0, config & 0xFC);
-        return;
-    case power_mode_t::LOWEST_POWER_WITH_NOISE:
-        config = (config & 0xFC) | 0x01;
-        config &= 0x9F;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        return;
-
-    case power_mode_t::ULTRA_LOW_POWER:
-        config = (config & 0xFC) | 0x01;
-        config = (config & 0x9F) | 0x20;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        return;
+#if defined(ARDUINO)
+    wire = _mux.wire;
+#endif
+    bus = _mux.bus;
+    mux = &_mux;
+    mux_channel = channel;
+    rate_descriptor_valid = false;
+    activity = activity_t::ACTIVITY_STILL;
+    address = _address;
+    return (read(BMA400_REG_CHIP_ID) == BMA400_CHIP_ID);
+}
 
-    case power_mode_t::LOW_POWER:
-        config = (config & 0xFC) | 0x01;
-        config = (config & 0x9F) | 0x40;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        return;
+/*!
+ *  @brief  Getting the mux channel of the sensor
+ *  @return channel or BMA400_MUX_NONE if the sensor is not behind a mux
+ */
+uint8_t BMA400::GetMuxChannel()
+{
+    return mux != nullptr ? mux_channel : BMA400_MUX_NONE;
+}
 
-    case power_mode_t::LOW_POWER_LOW_NOISE:
-        config = (config & 0xFC) | 0x01;
-        config = (config & 0x9F) | 0x60;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        return;
+/*!
+ *  @brief  Limiting the number of bytes per bus transaction. Longer reads and writes are split into chunks
+ *  @param  size maximum transaction size in bytes. 0 uses the size reported by the transport or the platform Wire buffer
+ */
+void BMA400::SetMaxTransferSize(uint16_t size)
+{
+    max_transfer_size = size;
+}
 
-    case power_mode_t::NORMAL_LOWER_POWER_WITH_NOISE:
-        config = (config & 0xFC) | 0x01;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        config = read(BMA400_REG_ACC_CONFIG_1);
-        config = config & 0xCF;
-        write(BMA400_REG_ACC_CONFIG_1, config);
-        return;
+/*!
+ *  @brief  Getting the maximum number of bytes per bus transaction
+ *  @return maximum transaction size in bytes
+ */
+uint16_t BMA400::GetMaxTransferSize()
+{
+    uint16_t size = max_transfer_size;
 
-    case power_mode_t::NORMAL:
-        config = (config & 0xFC) | 0x02;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        config = read(BMA400_REG_ACC_CONFIG_1);
-        config = (config & 0xCF) | 0x10;
-        write(BMA400_REG_ACC_CONFIG_1, config);
-        return;
+    if (size == 0 && bus != nullptr)
+        size = bus->GetMaxTransferSize();
 
-    case power_mode_t::NORMAL_LOW_NOISE:
-        config = (config & 0xFC) | 0x02;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        config = read(BMA400_REG_ACC_CONFIG_1);
-        config = (config & 0xCF) | 0x20;
-        write(BMA400_REG_ACC_CONFIG_1, config);
-        return;
+    if (size == 0)
+        size = bus != nullptr ? BMA400_FIFO_SIZE : BMA400_MAX_TRANSFER_SIZE;
 
-    case power_mode_t::NORMAL_LOWEST_NOISE:
-        config = (config & 0xFC) | 0x02;
-        write(BMA400_REG_ACC_CONFIG_0, config);
-        config = read(BMA400_REG_ACC_CONFIG_1);
-        config = (config & 0xCF) | 0x30;
-        write(BMA400_REG_ACC_CONFIG_1, config);
-        return;
+#if defined(ARDUINO)
+    if (bus == nullptr && size > 255) //# requestFrom takes up to 255 bytes
+        size = 255;
+#endif
 
-    default:
-        break;
-    }
+    return size < 2 ? 2 : size;
 }
 
 /*!
- *  @brief  Getting Acceleration - unprocessed 
- *  @param  values must be address of an array (uint16_t) with at least 3 elements 
+ *  @brief  Reading consecutive registers and reporting bus errors
+ *  @param  _register first register
+ *  @param  values receives the register values (0xFF if the read failed)
+ *  @param  length number of bytes to read
+ *  @return bus status of the read. see bus_status_t
  */
-void BMA400::ReadAcceleration(int16_t *values)
+BMA400::bus_status_t BMA400::ReadRegisters(uint8_t _register, uint8_t *values, uint16_t length)
 {
-    uint8_t data[6];
-
-    read(BMA400_REG_ACC_DATA, 6, data);
-
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        values[i] = data[0 + i * 2] + 256 * data[1 + i * 2];
-        if (values[i] > 2047)
-            values[i] -= 4096;
-    }
+    return read(_register, length, values);
 }
 
 /*!
- *  @brief  Getting Acceleration - processed in g
- *  @param  values must be address of an array (float) with at least 3 elements 
+ *  @brief  Writing consecutive registers and reporting bus errors
+ *  @param  _register first register
+ *  @param  values register values
+ *  @param  length number of bytes to write
+ *  @return bus status of the write. see bus_status_t
  */
-void BMA400::ReadAcceleration(float *values)
+BMA400::bus_status_t BMA400::WriteRegisters(uint8_t _register, const uint8_t *values, uint16_t length)
 {
-    uint8_t data[6];
-    float divider = 1;
-    read(BMA400_REG_ACC_DATA, 6, data);
-
-    switch (GetRange())
-    {
-    case acceleation_range_t::RANGE_2G:
-        divider = 1024;
-        break;
-
-    case acceleation_range_t::RANGE_4G:
-        divider = 512;
-        break;
-
-    case acceleation_range_t::RANGE_8G:
-        divider = 256;
-        break;
-
-    case acceleation_range_t::RANGE_16G:
-        divider = 128;
-        break;
-
-    default:
-        break;
-    }
+    invalidateRateDescriptor(_register, length);
+    return write(_register, length, values);
+}
 
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        values[i] = data[0 + i * 2] + 256 * data[1 + i * 2];
-        if (values[i] > 2047)
-            values[i] -= 4096;
-        values[i] /= divider;
-    }
+/*!
+ *  @brief  Getting (and clearing) the status of the last failed bus transaction.
+ * Use it after any other method to find out if the sensor was actually reached
+ *  @return BUS_OK if no transaction failed since the previous call. see bus_status_t
+ */
+BMA400::bus_status_t BMA400::GetLastBusStatus()
+{
+    bus_status_t status = last_bus_status;
+    last_bus_status = bus_status_t::BUS_OK;
+    return status;
 }
 
 /*!
- *  @brief  Checking if Auto Low Power on Data Ready is enabled
- *  @return true if Auto low power on Data Ready is enabled
+ *  @brief  Configuring retries of failed bus transactions
+ *  @param  retries number of retries after a failed transaction (0 disables retrying)
+ *  @param  backoff delay (us) before the first retry, doubled for each further retry (up to 2^15 x backoff).
+ *          Poll does not wait, its next call after the delay retries
+ *  @param  timeout time budget (us) of a call including all chunks and retries. 0 means no limit
  */
-bool BMA400::GetAutoLowPowerOnDataReady()
+void BMA400::ConfigureBusRetry(uint8_t retries, uint16_t backoff, uint32_t timeout)
 {
-    return (read(BMA400_REG_AUTO_LOW_POW_1) & 0x01) == 1;
+    bus_retries = retries;
+    bus_backoff = backoff;
+    bus_timeout = timeout;
 }
 
 /*!
- *  @brief  Checking if Auto Low Power on Generic Interrupt 1 is enabled
- *  @return true if Auto low power on Generic Interrupt 1 is enabled
+ *  @brief  Setting the function called before retrying a failed transaction, e.g. to free a stuck bus (see RecoverBus)
+ *  @param  handler recovery function. nullptr disables the recovery
  */
-bool BMA400::GetAutoLowPowerOnGenericInterrupt1()
+void BMA400::SetBusRecoveryHandler(bus_recovery_handler_t handler)
 {
-    return (read(BMA400_REG_AUTO_LOW_POW_1) & 0x02) == 2;
+    bus_recovery_handler = handler;
 }
 
 /*!
- *  @brief  Checking if Auto Low Power on timeout mode
- *  @return timeout mode. check auto_low_power_timeout_mode_t for more detail
+ *  @brief  Getting the bus error counters
+ *  @param  counters receives the counters. see bus_error_counters_t
  */
-BMA400::auto_low_power_timeout_mode_t BMA400::GetAutoLowPowerOnTimeoutMode()
+void BMA400::GetBusErrorCounters(bus_error_counters_t &counters)
 {
-    uint8_t val = read(BMA400_REG_AUTO_LOW_POW_1) & 0x0C;
-    switch (val)
-    {
-    case 0x00:
-        return auto_low_power_timeout_mode_t::DISABLE;
+    counters = bus_counters;
+}
 
-    case 0x04:
-    case 0x0C:
-        return auto_low_power_timeout_mode_t::ON_TIMEOUT;
+/*!
+ *  @brief  Clearing the bus error counters
+ */
+void BMA400::ResetBusErrorCounters()
+{
+    memset(&bus_counters, 0, sizeof(bus_counters));
+}
 
-    case 0x08:
-        return auto_low_power_timeout_mode_t::ON_TIMEOUT_RST_G_INT2;
+#if defined(ARDUINO)
+/*!
+ *  @brief  Freeing a bus held by a slave (SDA stuck low) by clocking SCL up to 9 times and generating a STOP condition.
+ * The I2C interface has to be started again (e.g. Wire.begin) afterwards
+ *  @param  sda SDA pin
+ *  @param  scl SCL pin
+ */
+void BMA400::RecoverBus(uint8_t sda, uint8_t scl)
+{
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, OUTPUT);
+    digitalWrite(scl, HIGH);
 
-    default:
-        return auto_low_power_timeout_mode_t::UNKNOWN_TIMEOUT;
+    for (uint8_t i = 0; i < 9 && digitalRead(sda) == LOW; i++)
+    {
+        digitalWrite(scl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(scl, HIGH);
+        delayMicroseconds(5);
     }
+
+    //# STOP condition
+    pinMode(sda, OUTPUT);
+    digitalWrite(sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(scl, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(sda, HIGH);
+    delayMicroseconds(5);
+
+    pinMode(sda, INPUT);
+    pinMode(scl, INPUT);
 }
+#endif
 
 /*!
- *  @brief  Getting Auto Low Power on Timeout threshold (time) in ms
- *  @return threshold in ms scale
+ *  @brief  Setting the lock used to share the bus (or the sensor) between tasks.
+ *          Every transaction and every read-modify-write of a register is done while holding the lock.
+ *          Without a lock (default) no locking code runs at all. The Queue/Poll functions are not
+ *          covered: the queue belongs to the task calling Poll
+ *  @param  _lock lock shared by all users of the bus, e.g. BMA400FreeRTOSLock. nullptr disables locking
  */
-float BMA400::GetAutoLowPowerOnTimeoutThreshold()
+void BMA400::SetLock(BMA400Lock *_lock)
 {
-    float threshold;
-    threshold = (read(BMA400_REG_AUTO_LOW_POW_1) & 0xF0) >> 4;
-    threshold += read(BMA400_REG_AUTO_LOW_POW_0) << 4;
-    threshold *= 2.5;
-    return threshold;
+    lock = _lock;
 }
 
 /*!
- *  @brief  Updating Auto Low Power On Data Ready
- *  @param  enable true will enable the auto low power
+ *  @brief  Starting a transaction group: the lock is held until EndTransaction, so a sequence of
+ *          calls (e.g. GetInterrupts + ReadAcceleration) is not interleaved with other tasks.
+ *          Groups can be nested. Does nothing without a lock
  */
-void BMA400::SetAutoLowPowerOnDataReady(bool enable)
+void BMA400::BeginTransaction()
 {
-    if (enable)
-        set(BMA400_REG_AUTO_LOW_POW_1, 0);
-    else
-        unset(BMA400_REG_AUTO_LOW_POW_1, 0);
+    if (lock != nullptr)
+        lock->Lock();
 }
 
 /*!
- *  @brief  Updating Auto Low Power On Generic Interrupt 1
- *  @param  enable true will enable the auto low power
+ *  @brief  Ending a transaction group started by BeginTransaction
  */
-void BMA400::SetAutoLowPowerOnGenericInterrupt1(bool enable)
+void BMA400::EndTransaction()
 {
-    if (enable)
-        set(BMA400_REG_AUTO_LOW_POW_1, 1);
-    else
-        unset(BMA400_REG_AUTO_LOW_POW_1, 1);
+    if (lock != nullptr)
+        lock->Unlock();
 }
 
 /*!
- *  @brief  Updating Auto Low Power On timeout
- *  @param  mode timeout mode. check auto_low_power_timeout_mode_t for more detail
- *  @param  timeout_threshold threshold in ms scale
+ *  @brief  Queuing a register read for cooperative (non-blocking) mode. The read is done by Poll()
+ *  @param  _register first register
+ *  @param  values receives the register values. must stay valid until the operation completes
+ *  @param  length number of bytes to read (one chunk per Poll call, see GetMaxTransferSize)
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
  */
-void BMA400::SetAutoLowPowerOnTimeout(auto_low_power_timeout_mode_t mode, float timeout_threshold)
+bool BMA400::QueueRead(uint8_t _register, uint8_t *values, uint16_t length, operation_callback_t callback, void *context)
 {
-    uint8_t val = read(BMA400_REG_AUTO_LOW_POW_1) & 0x03;
+    operation_t *op = enqueue(operation_type_t::OP_READ, _register, callback, context);
+    if (op == nullptr)
+        return false;
+    op->destination = values;
+    op->length = length;
+    return true;
+}
 
-    switch (mode)
-    {
-    case auto_low_power_timeout_mode_t::DISABLE:
-    case auto_low_power_timeout_mode_t::UNKNOWN_TIMEOUT:
-        // Do nothing
-        break;
-    case auto_low_power_timeout_mode_t::ON_TIMEOUT:
-        val |= 0x04;
-        break;
+/*!
+ *  @brief  Queuing a register write for cooperative (non-blocking) mode. The write is done by Poll()
+ *  @param  _register target register
+ *  @param  value register value
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
+ */
+bool BMA400::QueueWrite(uint8_t _register, uint8_t value, operation_callback_t callback, void *context)
+{
+    operation_t *op = enqueue(operation_type_t::OP_WRITE, _register, callback, context);
+    if (op == nullptr)
+        return false;
+    op->data[0] = value;
+    op->length = 1;
+    return true;
+}
 
-    case auto_low_power_timeout_mode_t::ON_TIMEOUT_RST_G_INT2:
-        val |= 0x08;
-        break;
-    }
+/*!
+ *  @brief  Queuing a read-modify-write of a register for cooperative (non-blocking) mode. Takes two Poll calls
+ *  @param  _register target register
+ *  @param  value bits to set
+ *  @param  mask bits of the current value to keep
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
+ */
+bool BMA400::QueueUpdate(uint8_t _register, uint8_t value, uint8_t mask, operation_callback_t callback, void *context)
+{
+    operation_t *op = enqueue(operation_type_t::OP_UPDATE, _register, callback, context);
+    if (op == nullptr)
+        return false;
+    op->value = value;
+    op->mask = mask;
+    return true;
+}
 
-    timeout_threshold /= 2.5;
-    val = ((uint8_t)remainder(timeout_threshold, 16)) << 4;
-    write(BMA400_REG_AUTO_LOW_POW_1, val);
+/*!
+ *  @brief  Queuing an acceleration read (unprocessed) for cooperative (non-blocking) mode
+ *  @param  values address of an array (int16_t) with at least 3 elements. must stay valid until the operation completes
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
+ */
+bool BMA400::QueueReadAcceleration(int16_t *values, operation_callback_t callback, void *context)
+{
+    operation_t *op = enqueue(operation_type_t::OP_READ_ACCELERATION, BMA400_REG_ACC_DATA, callback, context);
+    if (op == nullptr)
+        return false;
+    op->destination = values;
+    op->length = 6;
+    return true;
+}
 
-    write(BMA400_REG_AUTO_LOW_POW_0, (uint8_t)(timeout_threshold / 16));
+/*!
+ *  @brief  Queuing an interrupt status read for cooperative (non-blocking) mode
+ *  @param  interrupts receives the triggered interrupts (see GetInterrupts). must stay valid until the operation completes
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
+ */
+bool BMA400::QueueGetInterrupts(interrupt_source_t *interrupts, operation_callback_t callback, void *context)
+{
+    operation_t *op = enqueue(operation_type_t::OP_READ_INTERRUPTS, BMA400_REG_INT_STAT_0, callback, context);
+    if (op == nullptr)
+        return false;
+    op->destination = interrupts;
+    op->length = 3;
+    return true;
 }
 
 /*!
- *  @brief  Configuring Auto Low Power
- *  @param  onDataReady enables Auto Low Power on Data Ready
- *  @param  onGenericInterrupt1 enables Auto Low Power on Generic Interrupt 1
- *  @param  mode timeout mode. check auto_low_power_timeout_mode_t for more detail
- *  @param  timeout_threshold threshold in ms scale
+ *  @brief  Queuing a step counter read for cooperative (non-blocking) mode
+ *  @param  steps receives the total steps (see GetTotalSteps). must stay valid until the operation completes
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
  */
-void BMA400::ConfigureAutoLowPower(bool onDataReady, bool onGenericInterrupt1, auto_low_power_timeout_mode_t mode, float timeout_threshold)
+bool BMA400::QueueGetTotalSteps(uint32_t *steps, operation_callback_t callback, void *context)
 {
-    uint8_t val = 0;
+    operation_t *op = enqueue(operation_type_t::OP_READ_STEPS, BMA400_REG_STEP_CNT0, callback, context);
+    if (op == nullptr)
+        return false;
+    op->destination = steps;
+    op->length = 3;
+    return true;
+}
 
-    if (onDataReady)
-        val |= 0x01;
+/*!
+ *  @brief  Queuing a step counter & activity read for cooperative (non-blocking) mode. Activity changes are reported as in UpdateActivity
+ *  @param  status receives the steps and activity (see GetStepStatus). must stay valid until the operation completes
+ *  @param  callback called (from Poll) once the operation completes. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
+ */
+bool BMA400::QueueGetStepStatus(step_status_t *status, operation_callback_t callback, void *context)
+{
+    operation_t *op = enqueue(operation_type_t::OP_READ_STEP_STATUS, BMA400_REG_STEP_CNT0, callback, context);
+    if (op == nullptr)
+        return false;
+    op->destination = status;
+    op->length = 4;
+    return true;
+}
 
-    if (onGenericInterrupt1)
-        val |= 0x02;
+/*!
+ *  @brief  Queuing the configuration of Generic Interrupt 1 or 2 for cooperative (non-blocking) mode,
+ *          see ConfigureGenericInterrupt. The steps (pin mapping, ODR increase, enabling, configuration
+ *          burst) are queued together and take one or two Poll calls each; if a step fails the rest is dropped
+ *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  reference mode of updating reference acceleration. see generic_interrupt_reference_update_t
+ *  @param  mode Interrupt mode. On Activity or On Inactivity
+ *  @param  threshold threshold (raw value) LSB = 8mg
+ *  @param  duration minimum duration can generate interrupt - (raw value) depending on ODR
+ *  @param  hystersis hystersis amplitude. can be selected between 0, 24, 48, 96mg
+ *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ *  @param  all_combined if true uses AND logic applies on all axes to generate interrupts, otherwise OR logic
+ *  @param  ignoreSamplingRateFix if false automatically increases the ODR to 100Hz if it's lower
+ *  @param  callback called (from Poll) once the last step completes or a step fails. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if not a generic interrupt or the queue has no room for all steps (up to 5)
+ */
+bool BMA400::QueueConfigureGenericInterrupt(
+    interrupt_source_t interrupt, bool enable,
+    interrupt_pin_t pin,
+    generic_interrupt_reference_update_t reference,
+    generic_interrupt_mode_t mode,
+    uint8_t threshold,
+    uint16_t duration,
+    generic_interrupt_hysteresis_amplitude_t hystersis,
+    interrupt_data_source_t data_source,
+    bool enableX, bool enableY, bool enableZ,
+    bool all_combined, bool ignoreSamplingRateFix,
+    operation_callback_t callback, void *context)
+{
+    if ((interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_1) &
+        (interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_2)) //# ignore if not a generic interrupt
+        return false;
 
-    switch (mode)
-    {
-    case auto_low_power_timeout_mode_t::DISABLE:
-    case auto_low_power_timeout_mode_t::UNKNOWN_TIMEOUT:
-        // Do nothing
-        break;
-    case auto_low_power_timeout_mode_t::ON_TIMEOUT:
-        val |= 0x04;
-        break;
+    //# same bit in INT_CONFIG_0, INT1_MAP and INT2_MAP
+    uint8_t bit = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 0x04 : 0x08;
+    if (!enable) //# just disable the interrupt
+        return QueueUpdate(BMA400_REG_INT_CONFIG_0, 0x00, (uint8_t)~bit, callback, context);
 
-    case auto_low_power_timeout_mode_t::ON_TIMEOUT_RST_G_INT2:
-        val |= 0x08;
-        break;
-    }
+    if (BMA400_QUEUE_SIZE - queue_count < (ignoreSamplingRateFix ? 4 : 5))
+        return false;
 
-    timeout_threshold /= 2.5;
-    val = ((uint8_t)remainder(timeout_threshold, 16)) << 4;
+    //# Wiring Interrupt to Interrupt pins
+    chain(operation_type_t::OP_UPDATE, BMA400_REG_INT1_MAP,
+          (pin == interrupt_pin_t::INT_PIN_1) | (pin == interrupt_pin_t::INT_PIN_BOTH) ? bit : 0x00, (uint8_t)~bit);
+    chain(operation_type_t::OP_UPDATE, BMA400_REG_INT2_MAP,
+          (pin == interrupt_pin_t::INT_PIN_2) | (pin == interrupt_pin_t::INT_PIN_BOTH) ? bit : 0x00, (uint8_t)~bit);
 
-    write(BMA400_REG_AUTO_LOW_POW_1, val);
+    //# increasing the rate to be at least 100Hz
+    if (!ignoreSamplingRateFix)
+        chain(operation_type_t::OP_RAISE_RATE, BMA400_REG_ACC_CONFIG_0, 0x08, 0x00);
+
+    //# enabling interrupt
+    chain(operation_type_t::OP_UPDATE, BMA400_REG_INT_CONFIG_0, bit, (uint8_t)~bit);
 
-    write(BMA400_REG_AUTO_LOW_POW_0, (uint8_t)(timeout_threshold / 16));
+    //# config 0 to config 4 registers in one burst
+    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
+    operation_t *op = enqueue(operation_type_t::OP_WRITE, _register, callback, context);
+    encodeGenericInterrupt(reference, mode, threshold, duration, hystersis, data_source,
+                           enableX, enableY, enableZ, all_combined, op->data);
+    op->length = 5;
+    return true;
 }
 
 /*!
- *  @brief  Updating the data rate
- *  @param  rate data rate select one between 16 rates. see output_data_rate_t for more details
+ *  @brief  Queuing the configuration of the single and double tap interrupts for cooperative (non-blocking) mode,
+ *          see ConfigureTapInterrupt. The steps (pin mapping, ODR increase, enabling, configuration burst)
+ *          are queued together and take one or two Poll calls each; if a step fails the rest is dropped
+ *  @param  enableSingleTap true enables single tap interrupt otherwise it disables the interrupt
+ *  @param  enableDoubleTap true enables double tap interrupt otherwise it disables the interrupt
+ *  @param  axis tap axis can be either X, Y, or Z. use tap_axis_t data def
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  sensitivity sensitivity level to tap ranged from 7 (highest) to 0 (lowest). use tap_sensitivity_level_t type def
+ *  @param  pick_to_pick_interval maximum time between upper and lower peak of valid taps (in data samples). use tap_max_pick_to_pick_interval_t data type
+ *  @param  quiet_interval Minimum quiet time (no tap) between two consecutive taps (in data samples). use tap_min_quiet_between_taps_t data type
+ *  @param  double_taps_time Mininum time between two taps in a double tap (in data samples). use tap_min_quiet_inside_double_taps_t data type
+ *  @param  callback called (from Poll) once the last step completes or a step fails. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue has no room for all steps (4)
  */
-void BMA400::SetDataRate(output_data_rate_t rate)
+bool BMA400::QueueConfigureTapInterrupt(
+    bool enableSingleTap, bool enableDoubleTap,
+    tap_axis_t axis,
+    interrupt_pin_t pin,
+    tap_sensitivity_level_t sensitivity,
+    tap_max_pick_to_pick_interval_t pick_to_pick_interval,
+    tap_min_quiet_between_taps_t quiet_interval,
+    tap_min_quiet_inside_double_taps_t double_taps_time,
+    operation_callback_t callback, void *context)
 {
-    switch (rate)
-    {
-    case output_data_rate_t::Filter1_048x_800Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x0B, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
-
-    case output_data_rate_t::Filter1_024x_800Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x0B, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    if (!enableSingleTap & !enableDoubleTap) //# Just disable both interrupts
+        return QueueUpdate(BMA400_REG_INT_CONFIG_1, 0x00, 0xF3, callback, context);
 
-    case output_data_rate_t::Filter1_048x_400Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x0A, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    if (BMA400_QUEUE_SIZE - queue_count < 4)
+        return false;
 
-    case output_data_rate_t::Filter1_024x_400Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x0A, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    //# Wiring Interrupt to Interrupt pins
+    uint8_t val = 0;
+    if ((pin == interrupt_pin_t::INT_PIN_1) | (pin == interrupt_pin_t::INT_PIN_BOTH))
+        val |= 0x04;
+    if ((pin == interrupt_pin_t::INT_PIN_2) | (pin == interrupt_pin_t::INT_PIN_BOTH))
+        val |= 0x40;
+    chain(operation_type_t::OP_UPDATE, BMA400_REG_INT12_MAP, val, 0xBB);
 
-    case output_data_rate_t::Filter1_048x_200Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x09, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    //# Force increasing the ODR to 200Hz
+    chain(operation_type_t::OP_RAISE_RATE, BMA400_REG_ACC_CONFIG_0, 0x09, 0x00);
 
-    case output_data_rate_t::Filter1_024x_200Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x09, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    //# Enabling the interrupts
+    val = 0;
+    if (enableSingleTap)
+        val |= 0x04;
+    if (enableDoubleTap)
+        val |= 0x08;
+    chain(operation_type_t::OP_UPDATE, BMA400_REG_INT_CONFIG_1, val, 0xF3);
 
-    case output_data_rate_t::Filter1_048x_100Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x08, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    operation_t *op = enqueue(operation_type_t::OP_WRITE, BMA400_REG_TAP_CONFIG_0, callback, context);
+    encodeTapInterrupt(axis, sensitivity, pick_to_pick_interval, quiet_interval, double_taps_time, op->data);
+    op->length = 2;
+    return true;
+}
 
-    case output_data_rate_t::Filter1_024x_100Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x08, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+/*!
+ *  @brief  Advancing the queued operations by (at most) one bus transaction. Call it from the main loop.
+ *          Never blocks: after a failed transaction the calls return until the retry backoff elapsed
+ *  @return true if there are still queued operations
+ */
+bool BMA400::Poll()
+{
+    if (queue_count == 0)
+        return false;
 
-    case output_data_rate_t::Filter1_048x_50Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x07, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    //# waiting (without blocking) for the backoff of a failed transaction, see ConfigureBusRetry
+    if (poll_attempt > 0 && (int32_t)(micros() - poll_resume) < 0)
+        return true;
 
-    case output_data_rate_t::Filter1_024x_50Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x07, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
-        break;
+    operation_t &op = queue[queue_head];
+    bus_status_t status = bus_status_t::BUS_OK;
+    bool done = true;
+    polling = true;
 
-    case output_data_rate_t::Filter1_048x_25Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x06, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+    //# a failed transaction leaves the operation as it was, so a scheduled retry repeats the same step
+    switch (op.type)
+    {
+    case operation_type_t::OP_READ:
+    {
+        uint16_t chunk = GetMaxTransferSize();
+        uint16_t size = op.length - op.offset > chunk ? chunk : op.length - op.offset;
+        uint8_t _register = op._register == BMA400_REG_FIFO_DATA ? op._register : op._register + op.offset;
+        status = transfer(_register, size, (uint8_t *)op.destination + op.offset, false, micros());
+        if (status != bus_status_t::BUS_OK)
+            break;
+        op.offset += size;
+        done = op.offset >= op.length;
         break;
+    }
 
-    case output_data_rate_t::Filter1_024x_25Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x06, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+    case operation_type_t::OP_WRITE:
+        status = transfer(op._register, op.length, op.data, true, micros());
+        invalidateRateDescriptor(op._register, op.length);
         break;
 
-    case output_data_rate_t::Filter1_048x_12Hz:
-        unset(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x05, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+    case operation_type_t::OP_UPDATE:
+        if (op.offset == 0) //# reading the current value
+        {
+            status = transfer(op._register, 1, op.data, false, micros());
+            if (status != bus_status_t::BUS_OK)
+                break;
+            op.offset = 1;
+            done = false;
+        }
+        else //# writing the updated value
+        {
+            op.data[1] = (op.data[0] & op.mask) | op.value;
+            status = transfer(op._register, 1, op.data + 1, true, micros());
+            invalidateRateDescriptor(op._register, 1);
+        }
         break;
 
-    case output_data_rate_t::Filter1_024x_12Hz:
-        set(BMA400_REG_ACC_CONFIG_0, 7);
-        write(BMA400_REG_ACC_CONFIG_1, 0x05, 0xF0);
-        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+    case operation_type_t::OP_RAISE_RATE:
+        if (op.offset == 0) //# reading ACC_CONFIG_0 to ACC_CONFIG_2
+        {
+            status = transfer(op._register, 3, op.data, false, micros());
+            if (status != bus_status_t::BUS_OK)
+                break;
+            op.offset = 1;
+            memcpy(op.data + 3, op.data, 3);
+            done = !raiseDataRate(op.data + 3, op.value);
+        }
+        else //# writing only the registers that changed
+        {
+            uint8_t first = 0;
+            uint8_t last = 2;
+            while (op.data[first] == op.data[3 + first])
+                first++;
+            while (op.data[last] == op.data[3 + last])
+                last--;
+            status = transfer(op._register + first, last - first + 1, op.data + 3 + first, true, micros());
+            invalidateRateDescriptor(op._register + first, last - first + 1);
+        }
         break;
 
-    case output_data_rate_t::Filter2_100Hz:
-        write(BMA400_REG_ACC_CONFIG_2, 0x04, 0xF3);
+    case operation_type_t::OP_READ_FIFO:
+    {
+        sample_block_t &block = *(sample_block_t *)op.destination;
+        if (op.offset == 0) //# reading the FIFO length
+        {
+            status = transfer(op._register, 2, op.data, false, micros());
+            if (status != bus_status_t::BUS_OK)
+                break;
+            op.offset = 1;
+            done = !startFifoDrain(block, op.drain, op.data[0] + (op.data[1] & 0x07) * 256);
+        }
+        else
+        {
+            status = stepFifoDrain(block, op.drain);
+            done = status != bus_status_t::BUS_OK || !isFifoDrainPending(block, op.drain);
+        }
         break;
+    }
 
-    case output_data_rate_t::Filter2_100Hz_LPF_1Hz:
-        write(BMA400_REG_ACC_CONFIG_2, 0x08, 0xF3);
-        break;
+    case operation_type_t::OP_READ_ACCELERATION:
+    case operation_type_t::OP_READ_INTERRUPTS:
+    case operation_type_t::OP_READ_STEPS:
+    case operation_type_t::OP_READ_STEP_STATUS:
+        status = transfer(op._register, op.length, op.data, false, micros());
+        if (status != bus_status_t::BUS_OK)
+            break;
 
-    default:
+        if (op.type == operation_type_t::OP_READ_ACCELERATION)
+            decodeAcceleration(op.data, (int16_t *)op.destination);
+        else if (op.type == operation_type_t::OP_READ_INTERRUPTS)
+        {
+            *(interrupt_source_t *)op.destination = decodeInterrupts(op.data);
+#if defined(BMA400_TELEMETRY)
+            recordInterrupts(*(interrupt_source_t *)op.destination);
+#endif
+        }
+        else if (op.type == operation_type_t::OP_READ_STEP_STATUS)
+        {
+            polling = false; //# the activity callback may use the bus (blocking)
+            decodeStepStatus(op.data, *(step_status_t *)op.destination);
+            reportActivity(*(step_status_t *)op.destination);
+        }
+        else
+            *(uint32_t *)op.destination = op.data[0] + op.data[1] * 256 + (uint32_t)op.data[2] * 256 * 256;
         break;
     }
-}
 
-/*!
- *  @brief  Getting the data rate
- *  @return  data rate (16 rates). see output_data_rate_t for more details
- */
-BMA400::output_data_rate_t BMA400::GetDataRate()
-{
-    uint8_t val = read(BMA400_REG_ACC_CONFIG_2);
-
-    if (val == 0x04)
-        return output_data_rate_t::Filter2_100Hz;
-    else if (val == 0x08)
-        return output_data_rate_t::Filter2_100Hz_LPF_1Hz;
-
-    val = read(BMA400_REG_ACC_CONFIG_1) & 0x0F;
-    bool is24x = (read(BMA400_REG_ACC_CONFIG_0) & 0x80) == 0x80;
-
-    if (val >= 0x0B)
-        return is24x ? output_data_rate_t::Filter1_024x_800Hz : output_data_rate_t::Filter1_048x_800Hz;
-    else if (val <= 0x05)
-        return is24x ? output_data_rate_t::Filter1_024x_12Hz : output_data_rate_t::Filter1_048x_12Hz;
+    polling = false;
+    if (poll_attempt > 0) //# retried by a later call
+        return true;
 
-    switch (val)
+    if (done)
     {
-    case 0x0A:
-        return is24x ? output_data_rate_t::Filter1_024x_400Hz : output_data_rate_t::Filter1_048x_400Hz;
-
-    case 0x09:
-        return is24x ? output_data_rate_t::Filter1_024x_200Hz : output_data_rate_t::Filter1_048x_200Hz;
-
-    case 0x08:
-        return is24x ? output_data_rate_t::Filter1_024x_100Hz : output_data_rate_t::Filter1_048x_100Hz;
+        //# a failed step drops the rest of its request, whose callback is on the last step
+        while (status != bus_status_t::BUS_OK && queue[queue_head].chained)
+        {
+            queue_head = (queue_head + 1) % BMA400_QUEUE_SIZE;
+            queue_count--;
+        }
 
-    case 0x07:
-        return is24x ? output_data_rate_t::Filter1_024x_50Hz : output_data_rate_t::Filter1_048x_50Hz;
+        //# removing the operation before the callback, so the callback can queue new operations
+        operation_callback_t callback = queue[queue_head].callback;
+        void *context = queue[queue_head].context;
+        queue_head = (queue_head + 1) % BMA400_QUEUE_SIZE;
+        queue_count--;
 
-    case 0x06:
-        return is24x ? output_data_rate_t::Filter1_024x_25Hz : output_data_rate_t::Filter1_048x_25Hz;
+        if (callback != nullptr)
+            callback(status, context);
     }
 
-    return output_data_rate_t::UNKNOWN_RATE;
+    return queue_count > 0;
 }
 
 /*!
- *  @brief  Updating the sampling range
- *  @param  range sampling range 2, 4, 8, 16G. Use acceleation_range_t data type
+ *  @brief  Getting the number of queued operations
+ *  @return number of queued operations (including the one in progress)
  */
-void BMA400::SetRange(acceleation_range_t range)
+uint8_t BMA400::GetQueuedOperations()
 {
-    switch (range)
-    {
-    case acceleation_range_t::RANGE_2G:
-        write(BMA400_REG_ACC_CONFIG_1, 0x00, 0x3F);
-        break;
-
-    case acceleation_range_t::RANGE_4G:
-        write(BMA400_REG_ACC_CONFIG_1, 0x40, 0x3F);
-        break;
-
-    case acceleation_range_t::RANGE_8G:
-        write(BMA400_REG_ACC_CONFIG_1, 0x80, 0x3F);
-        break;
-
-    case acceleation_range_t::RANGE_16G:
-        write(BMA400_REG_ACC_CONFIG_1, 0xC0, 0x3F);
-        break;
-
-    default:
-        break;
-    }
+    return queue_count;
 }
 
 /*!
- *  @brief  Getting the sampling range
- *  @return sampling range 2, 4, 8, 16G acceleation_range_t data type
+ *  @brief  Dropping all queued operations without calling their callbacks
  */
-BMA400::acceleation_range_t BMA400::GetRange()
+void BMA400::ClearQueue()
 {
-    switch (read(BMA400_REG_ACC_CONFIG_1) & 0xC0)
-    {
-    case 0x00:
-        return acceleation_range_t::RANGE_2G;
-
-    case 0x40:
-        return acceleation_range_t::RANGE_4G;
-
-    case 0x80:
-        return acceleation_range_t::RANGE_8G;
-
-    case 0xC0:
-        return acceleation_range_t::RANGE_16G;
-    }
-
-    return acceleation_range_t::UNKNOWN_RANGE;
+    queue_head = 0;
+    queue_count = 0;
+    poll_attempt = 0;
 }
 
+#if defined(BMA400_TELEMETRY)
 /*!
- *  @brief  Getting all triggered interrupts
- *  @return combination of all interrupts if there is more than one
+ *  @brief  Marking an interrupt pin edge for the latency histogram. Call it from the pin ISR (lock-free,
+ *  only a timestamp and a counter are written)
  */
-BMA400::interrupt_source_t BMA400::GetInterrupts()
+void BMA400::MarkInterruptEdge()
 {
-    uint16_t result = 0;
-    uint8_t interrupts[3] = {0};
-    read(BMA400_REG_INT_STAT_0, 3, interrupts);
-
-    if (interrupts[0] & 0x01)
-        result |= interrupt_source_t::BAS_WAKEUP;
-
-    if (interrupts[0] & 0x02)
-        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE;
-
-    if (interrupts[0] & 0x04)
-        result |= interrupt_source_t::ADV_GENERIC_INTERRUPT_1;
-
-    if (interrupts[0] & 0x08)
-        result |= interrupt_source_t::ADV_GENERIC_INTERRUPT_2;
-
-    if ((interrupts[0] & 0x10) | (interrupts[1] & 0x10) | (interrupts[2] & 0x10))
-        result |= interrupt_source_t::BAS_ENGINE_OVERRUN;
-
-    if (interrupts[0] & 0x20)
-        result |= interrupt_source_t::BAS_FIFO_FULL;
-
-    if (interrupts[0] & 0x40)
-        result |= interrupt_source_t::BAS_FIFO_WATERMARK;
-
-    if (interrupts[0] & 0x80)
-        result |= interrupt_source_t::BAS_DATA_READY;
-
-    if (interrupts[1] & 0x01)
-        result |= interrupt_source_t::ADV_STEP_DETECTOR_COUNTER;
-
-    if (interrupts[1] & 0x02)
-        result |= interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP;
-
-    if (interrupts[1] & 0x04)
-        result |= interrupt_source_t::ADV_SINGLE_TAP;
-
-    if (interrupts[1] & 0x08)
-        result |= interrupt_source_t::ADV_DOUBLE_TAP;
-
-    if (interrupts[2] & 0x01)
-        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE_X;
-
-    if (interrupts[2] & 0x02)
-        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE_Y;
+    edge_time = micros();
+    edge_count = edge_count + 1;
+}
 
-    if (interrupts[2] & 0x04)
-        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE_Z;
+/*!
+ *  @brief  Copying the interrupt telemetry (counters of the decoded interrupt status reads and the latency
+ *  from the last marked edge to the decoded event)
+ *  @param  _telemetry receives the telemetry
+ *  @return false if an update was in progress (e.g. called from an interrupt), try again later
+ */
+bool BMA400::GetTelemetry(telemetry_t &_telemetry)
+{
+    uint16_t sequence = telemetry_sequence;
+    __sync_synchronize();
+    _telemetry = telemetry;
+    __sync_synchronize();
+    if ((sequence & 0x01) != 0 || sequence != telemetry_sequence)
+        return false;
 
-    return (interrupt_source_t)result;
+    _telemetry.edges = getEdgeCount() - edge_base;
+    return true;
 }
 
 /*!
- *  @brief  Checks if an specific interrupt is rised after reading all interrupts blindly.
- *  Not a good idea to use this method if you enabled multiple interrupts
- *  @return true if the target interrupt is triggered
+ *  @brief  Clearing the interrupt telemetry
  */
-bool BMA400::HasInterrupt(interrupt_source_t source)
+void BMA400::ResetTelemetry()
 {
-    return (bool)(GetInterrupts() & source);
+    telemetry_sequence = telemetry_sequence + 1;
+    __sync_synchronize();
+    telemetry = {};
+    edge_base = getEdgeCount();
+    edge_served = edge_base;
+    __sync_synchronize();
+    telemetry_sequence = telemetry_sequence + 1;
 }
+#endif
 
 /*!
- *  @brief  Disabling Interrupts
- *  @param  source Interrupt source. use ALL_INTERRUPTS to disable all interrupts (very usefull if don't know which interrupts are active)
- *  @param  enable true to enable interrupt
+ *  @brief  Quick Stepup for BMA400
+ *  @param  mode power mode see power_mode_t for more details
+ *  @param  rate data rate select one between 16 rates. see output_data_rate_t for more details
+ *  @param  range sampling range 2, 4, 8, 16G. Use acceleation_range_t data type
  */
-void BMA400::DisableInterrupts(interrupt_source_t source)
+void BMA400::Setup(const power_mode_t &mode, output_data_rate_t rate, acceleation_range_t range)
 {
-    switch (source)
-    {
-    case interrupt_source_t::ALL_INTERRUPTS:
-        write(BMA400_REG_INT_CONFIG_0, 0);
-        write(BMA400_REG_INT_CONFIG_1, 0);
-        break;
-
-    case interrupt_source_t::BAS_DATA_READY:
-        unset(BMA400_REG_INT_CONFIG_0, 7);
-        break;
-
-    case interrupt_source_t::BAS_FIFO_WATERMARK:
-        unset(BMA400_REG_INT_CONFIG_0, 6);
-        break;
-
-    case interrupt_source_t::BAS_FIFO_FULL:
-        unset(BMA400_REG_INT_CONFIG_0, 5);
-        break;
+    SetPowerMode(mode);
+    SetRange(range);
+    SetDataRate(rate);
+}
 
-    case interrupt_source_t::ADV_GENERIC_INTERRUPT_2:
-        unset(BMA400_REG_INT_CONFIG_0, 4);
-        break;
+/*!
+ *  @brief  Runs command
+ *  @param  cmd check command_t for more details
+ *  @return true if command is sent successfully
+ */
+bool BMA400::ExecuteCommand(command_t cmd)
+{
+    if ((read(BMA400_REG_STATUS) & 0x10) != 0x10)
+        return false;
 
-    case interrupt_source_t::ADV_GENERIC_INTERRUPT_1:
-        unset(BMA400_REG_INT_CONFIG_0, 3);
-        break;
+    write(BMA400_REG_COMMAND, cmd);
+    if (cmd == command_t::CMD_SOFT_RESET)
+        rate_descriptor_valid = false; //# data rate and range are back to their defaults
+    return true;
+}
 
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE:
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE_X:
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Y:
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Z:
-        unset(BMA400_REG_INT_CONFIG_0, 2);
-        break;
+/*!
+ *  @brief  Getting current power mode (9 modes) includes Sleep/Low/Normal and 4 level of noise performance
+ *  @return power mode. see power_mode_t for more details
+ */
+BMA400::power_mode_t BMA400::GetPowerMode()
+{
 
-    case interrupt_source_t::ADV_ACTIVITY_CHANGE:
-        unset(BMA400_REG_INT_CONFIG_1, 4);
-        break;
+    switch (read(BMA400_REG_ACC_CONFIG_0) & 0x03)
+    {
+    case 0:
+    case 3:
+        return power_mode_t::SLEEP;
 
-    case interrupt_source_t::ADV_DOUBLE_TAP:
-        unset(BMA400_REG_INT_CONFIG_0, 3);
+    case 1: //# Low Power
+        switch ((read(BMA400_REG_ACC_CONFIG_0) >> 5) & 0x03)
+        {
+        case 0:
+            return power_mode_t::LOWEST_POWER_WITH_NOISE;
+        case 1:
+            return power_mode_t::ULTRA_LOW_POWER;
+        case 2:
+            return power_mode_t::LOW_POWER;
+        case 3:
+            return power_mode_t::LOW_POWER_LOW_NOISE;
+        default:
+            return power_mode_t::UNKNOWN_MODE;
+        }
         break;
 
-    case interrupt_source_t::ADV_SINGLE_TAP:
-        unset(BMA400_REG_INT_CONFIG_0, 2);
-        break;
+    case 2:
+        switch ((read(BMA400_REG_ACC_CONFIG_1) >> 4) & 0x03)
+        {
+        case 0:
+            return power_mode_t::NORMAL_LOWER_POWER_WITH_NOISE;
+        case 1:
+            return power_mode_t::NORMAL;
+        case 2:
+            return power_mode_t::NORMAL_LOW_NOISE;
+        case 3:
+            return power_mode_t::NORMAL_LOWEST_NOISE;
 
-    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER:
-    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP:
-        unset(BMA400_REG_INT_CONFIG_0, 0);
+        default:
+            return power_mode_t::UNKNOWN_MODE;
+        }
         break;
 
     default:
-        break;
+        return power_mode_t::UNKNOWN_MODE;
     }
+    return power_mode_t::UNKNOWN_MODE;
 }
 
 /*!
- *  @brief  Enabling/Disabling Basic Interrupts
- *  @param  source Interrupt source. can be either Data Ready, FIFO Full or FIFO Watermark
- *  @param  enable true to enable interrupt
+ *  @brief  Updating the power mode 
+ *  @param  mode power mode see power_mode_t for more details
  */
-void BMA400::ConfigureBasicInterrupts(interrupt_source_t source, bool enable)
+void BMA400::SetPowerMode(const power_mode_t &mode)
 {
-    switch (source)
-    {
-    case interrupt_source_t::BAS_DATA_READY:
-        if (enable)
-            set(BMA400_REG_INT_CONFIG_0, 7);
-        else
-            unset(BMA400_REG_INT_CONFIG_0, 7);
-        break;
+    uint8_t config = read(BMA400_REG_ACC_CONFIG_0);
 
-    case interrupt_source_t::BAS_FIFO_WATERMARK:
-        if (enable)
-            set(BMA400_REG_INT_CONFIG_0, 6);
-        else
-            unset(BMA400_REG_INT_CONFIG_0, 6);
-        break;
+    switch (mode)
+    {
+    case power_mode_t::SLEEP:
+        write(BMA400_REG_ACC_CONFIG_0, config & 0xFC);
+        return;
+    case power_mode_t::LOWEST_POWER_WITH_NOISE:
+        config = (config & 0xFC) | 0x01;
+        config &= 0x9F;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        return;
 
-    case interrupt_source_t::BAS_FIFO_FULL:
-        if (enable)
-            set(BMA400_REG_INT_CONFIG_0, 5);
-        else
-            unset(BMA400_REG_INT_CONFIG_0, 5);
-        break;
+    case power_mode_t::ULTRA_LOW_POWER:
+        config = (config & 0xFC) | 0x01;
+        config = (config & 0x9F) | 0x20;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        return;
+
+    case power_mode_t::LOW_POWER:
+        config = (config & 0xFC) | 0x01;
+        config = (config & 0x9F) | 0x40;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        return;
+
+    case power_mode_t::LOW_POWER_LOW_NOISE:
+        config = (config & 0xFC) | 0x01;
+        config = (config & 0x9F) | 0x60;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        return;
+
+    case power_mode_t::NORMAL_LOWER_POWER_WITH_NOISE:
+        config = (config & 0xFC) | 0x01;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        config = read(BMA400_REG_ACC_CONFIG_1);
+        config = config & 0xCF;
+        write(BMA400_REG_ACC_CONFIG_1, config);
+        return;
+
+    case power_mode_t::NORMAL:
+        config = (config & 0xFC) | 0x02;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        config = read(BMA400_REG_ACC_CONFIG_1);
+        config = (config & 0xCF) | 0x10;
+        write(BMA400_REG_ACC_CONFIG_1, config);
+        return;
+
+    case power_mode_t::NORMAL_LOW_NOISE:
+        config = (config & 0xFC) | 0x02;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        config = read(BMA400_REG_ACC_CONFIG_1);
+        config = (config & 0xCF) | 0x20;
+        write(BMA400_REG_ACC_CONFIG_1, config);
+        return;
+
+    case power_mode_t::NORMAL_LOWEST_NOISE:
+        config = (config & 0xFC) | 0x02;
+        write(BMA400_REG_ACC_CONFIG_0, config);
+        config = read(BMA400_REG_ACC_CONFIG_1);
+        config = (config & 0xCF) | 0x30;
+        write(BMA400_REG_ACC_CONFIG_1, config);
+        return;
 
     default:
-        // Ignore the rest
         break;
     }
 }
 
 /*!
- *  @brief  Configure Basic Interrupts (Enabling/Disabling & Linking to Interrupt Pins)
- *  @param  source Interrupt source. can be either Data Ready, FIFO Full or FIFO Watermark
- *  @param  enable true to enable interrupt
- *  @param  pin target interrupt pin. see interrupt_pin_t for more detail
+ *  @brief  Getting Acceleration - unprocessed 
+ *  @param  values must be address of an array (uint16_t) with at least 3 elements 
  */
-void BMA400::ConfigureBasicInterrupts(interrupt_source_t source, bool enable, interrupt_pin_t pin)
+void BMA400::ReadAcceleration(int16_t *values)
 {
-    ConfigureBasicInterrupts(source, enable);
-    LinkToInterruptPin(source, pin);
+    uint8_t data[6];
+
+    read(BMA400_REG_ACC_DATA, 6, data);
+    decodeAcceleration(data, values);
 }
 
 /*!
- *  @brief  Configuring electrical behavior of interrupt pins
- *  @param  isLatched set true to enable latched (hold) interrupt. In latch mode interrupt stays active until reading the corresponding interrupt register is read.
- *  @param  isINT1_active_hi set true to set interrupt pin 1 active mode to high level (pull up), otherwise it's pulled down when active
- *  @param  isINT2_active_hi set true to set interrupt pin 1 active mode to high level (pull up), otherwise it's pulled down when active
- *  @param  isINT1_open_drive set true to enable open drive mode for Interrupt Pin 1, otherwise it is using push pull electrical drive
- *  @param  isINT2_open_drive set true to enable open drive mode for Interrupt Pin 1, otherwise it is using push pull electrical drive
+ *  @brief  Getting Acceleration - unprocessed, read straight into the next sample of a block
+ *  @param  block block to append to, e.g. from BMA400BufferPool::Acquire
+ *  @return false if the block is full or the read failed
  */
-void BMA400::ConfigureInterruptPinSettings(
-    bool isLatched,
-    bool isINT1_active_hi,
-    bool isINT2_active_hi,
-    bool isINT1_open_drive,
-    bool isINT2_open_drive)
+bool BMA400::ReadAcceleration(sample_block_t &block)
 {
-    if (isLatched)
-        set(BMA400_REG_INT_CONFIG_1, 7);
-    else
-        unset(BMA400_REG_INT_CONFIG_1, 7);
+    if (block.count >= block.capacity)
+        return false;
 
-    uint8_t val = 0;
+    int16_t *sample = block.values + block.count * 3;
+    if (read(BMA400_REG_ACC_DATA, 6, (uint8_t *)sample) != bus_status_t::BUS_OK)
+        return false;
 
-    if (isINT1_active_hi)
-        val |= 0x02;
+    decodeAcceleration((uint8_t *)sample, sample); //# each value is read before it is overwritten
+    block.count++;
+    return true;
+}
 
-    if (isINT2_active_hi)
-        val |= 0x20;
+/*!
+ *  @brief  Getting Acceleration - processed in g
+ *  @param  values must be address of an array (float) with at least 3 elements 
+ */
+void BMA400::ReadAcceleration(float *values)
+{
+    uint8_t data[6];
+    float divider = GetRateDescriptor().lsb_per_g;
+    read(BMA400_REG_ACC_DATA, 6, data);
 
-    if (isINT1_open_drive)
-        val |= 0x04;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        values[i] = data[0 + i * 2] + 256 * data[1 + i * 2];
+        if (values[i] > 2047)
+            values[i] -= 4096;
+        values[i] /= divider;
+    }
+}
 
-    if (isINT2_open_drive)
-        val |= 0x40;
+/*!
+ *  @brief  Checking if Auto Low Power on Data Ready is enabled
+ *  @return true if Auto low power on Data Ready is enabled
+ */
+bool BMA400::GetAutoLowPowerOnDataReady()
+{
+    return (read(BMA400_REG_AUTO_LOW_POW_1) & 0x01) == 1;
+}
 
-    write(BMA400_REG_INT_IO_CTRL, val);
+/*!
+ *  @brief  Checking if Auto Low Power on Generic Interrupt 1 is enabled
+ *  @return true if Auto low power on Generic Interrupt 1 is enabled
+ */
+bool BMA400::GetAutoLowPowerOnGenericInterrupt1()
+{
+    return (read(BMA400_REG_AUTO_LOW_POW_1) & 0x02) == 2;
 }
 
 /*!
- *  @brief  Links/unlinks an interrupt source to/from interrupt pins
- *  @param  interrupt Interrupt source (can be any interrupt source)
- *  @param  pin target pin(s) should be linked to the interrupt source. can either, none or both
+ *  @brief  Checking if Auto Low Power on timeout mode
+ *  @return timeout mode. check auto_low_power_timeout_mode_t for more detail
  */
-void BMA400::LinkToInterruptPin(interrupt_source_t interrupt, interrupt_pin_t pin)
+BMA400::auto_low_power_timeout_mode_t BMA400::GetAutoLowPowerOnTimeoutMode()
 {
-    switch (interrupt)
+    uint8_t val = read(BMA400_REG_AUTO_LOW_POW_1) & 0x0C;
+    switch (val)
     {
-    case interrupt_source_t::BAS_DATA_READY:
-        switch (pin)
-        {
-
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 7);
-            unset(BMA400_REG_INT2_MAP, 7);
-            break;
+    case 0x00:
+        return auto_low_power_timeout_mode_t::DISABLE;
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 7);
-            unset(BMA400_REG_INT2_MAP, 7);
-            break;
+    case 0x04:
+    case 0x0C:
+        return auto_low_power_timeout_mode_t::ON_TIMEOUT;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 7);
-            set(BMA400_REG_INT2_MAP, 7);
-            break;
+    case 0x08:
+        return auto_low_power_timeout_mode_t::ON_TIMEOUT_RST_G_INT2;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 7);
-            set(BMA400_REG_INT2_MAP, 7);
-            break;
-        }
-        break;
+    default:
+        return auto_low_power_timeout_mode_t::UNKNOWN_TIMEOUT;
+    }
+}
 
-    case interrupt_source_t::BAS_FIFO_WATERMARK:
-        switch (pin)
-        {
+/*!
+ *  @brief  Getting Auto Low Power on Timeout threshold (time) in ms
+ *  @return threshold in ms scale
+ */
+float BMA400::GetAutoLowPowerOnTimeoutThreshold()
+{
+    float threshold;
+    threshold = (read(BMA400_REG_AUTO_LOW_POW_1) & 0xF0) >> 4;
+    threshold += read(BMA400_REG_AUTO_LOW_POW_0) << 4;
+    threshold *= 2.5;
+    return threshold;
+}
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 6);
-            unset(BMA400_REG_INT2_MAP, 6);
-            break;
+/*!
+ *  @brief  Updating Auto Low Power On Data Ready
+ *  @param  enable true will enable the auto low power
+ */
+void BMA400::SetAutoLowPowerOnDataReady(bool enable)
+{
+    if (enable)
+        set(BMA400_REG_AUTO_LOW_POW_1, 0);
+    else
+        unset(BMA400_REG_AUTO_LOW_POW_1, 0);
+}
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 6);
-            unset(BMA400_REG_INT2_MAP, 6);
-            break;
+/*!
+ *  @brief  Updating Auto Low Power On Generic Interrupt 1
+ *  @param  enable true will enable the auto low power
+ */
+void BMA400::SetAutoLowPowerOnGenericInterrupt1(bool enable)
+{
+    if (enable)
+        set(BMA400_REG_AUTO_LOW_POW_1, 1);
+    else
+        unset(BMA400_REG_AUTO_LOW_POW_1, 1);
+}
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 6);
-            set(BMA400_REG_INT2_MAP, 6);
-            break;
+/*!
+ *  @brief  Updating Auto Low Power On timeout
+ *  @param  mode timeout mode. check auto_low_power_timeout_mode_t for more detail
+ *  @param  timeout_threshold threshold in ms scale
+ */
+void BMA400::SetAutoLowPowerOnTimeout(auto_low_power_timeout_mode_t mode, float timeout_threshold)
+{
+    uint8_t val = read(BMA400_REG_AUTO_LOW_POW_1) & 0x03;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 6);
-            set(BMA400_REG_INT2_MAP, 6);
-            break;
-        }
+    switch (mode)
+    {
+    case auto_low_power_timeout_mode_t::DISABLE:
+    case auto_low_power_timeout_mode_t::UNKNOWN_TIMEOUT:
+        // Do nothing
+        break;
+    case auto_low_power_timeout_mode_t::ON_TIMEOUT:
+        val |= 0x04;
         break;
 
-    case interrupt_source_t::BAS_FIFO_FULL:
-        switch (pin)
-        {
+    case auto_low_power_timeout_mode_t::ON_TIMEOUT_RST_G_INT2:
+        val |= 0x08;
+        break;
+    }
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 5);
-            unset(BMA400_REG_INT2_MAP, 5);
-            break;
+    uint16_t ticks = timeout_threshold > 10237.5 ? 0x0FFF : (uint16_t)round(timeout_threshold / 2.5);
+    val |= (ticks & 0x0F) << 4;
+    write(BMA400_REG_AUTO_LOW_POW_1, val);
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 5);
-            unset(BMA400_REG_INT2_MAP, 5);
-            break;
+    write(BMA400_REG_AUTO_LOW_POW_0, (uint8_t)(ticks >> 4));
+}
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 5);
-            set(BMA400_REG_INT2_MAP, 5);
-            break;
+/*!
+ *  @brief  Configuring Auto Low Power
+ *  @param  onDataReady enables Auto Low Power on Data Ready
+ *  @param  onGenericInterrupt1 enables Auto Low Power on Generic Interrupt 1
+ *  @param  mode timeout mode. check auto_low_power_timeout_mode_t for more detail
+ *  @param  timeout_threshold threshold in ms scale
+ */
+void BMA400::ConfigureAutoLowPower(bool onDataReady, bool onGenericInterrupt1, auto_low_power_timeout_mode_t mode, float timeout_threshold)
+{
+    uint8_t val = 0;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 5);
-            set(BMA400_REG_INT2_MAP, 5);
-            break;
-        }
+    if (onDataReady)
+        val |= 0x01;
+
+    if (onGenericInterrupt1)
+        val |= 0x02;
+
+    switch (mode)
+    {
+    case auto_low_power_timeout_mode_t::DISABLE:
+    case auto_low_power_timeout_mode_t::UNKNOWN_TIMEOUT:
+        // Do nothing
+        break;
+    case auto_low_power_timeout_mode_t::ON_TIMEOUT:
+        val |= 0x04;
         break;
 
-    case interrupt_source_t::BAS_ENGINE_OVERRUN:
-        switch (pin)
-        {
+    case auto_low_power_timeout_mode_t::ON_TIMEOUT_RST_G_INT2:
+        val |= 0x08;
+        break;
+    }
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 4);
-            unset(BMA400_REG_INT2_MAP, 4);
-            break;
+    uint16_t ticks = timeout_threshold > 10237.5 ? 0x0FFF : (uint16_t)round(timeout_threshold / 2.5);
+    val |= (ticks & 0x0F) << 4;
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 4);
-            unset(BMA400_REG_INT2_MAP, 4);
-            break;
+    write(BMA400_REG_AUTO_LOW_POW_1, val);
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 4);
-            set(BMA400_REG_INT2_MAP, 4);
-            break;
+    write(BMA400_REG_AUTO_LOW_POW_0, (uint8_t)(ticks >> 4));
+}
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 4);
-            set(BMA400_REG_INT2_MAP, 4);
-            break;
-        }
-        break;
+/*!
+ *  @brief  Checking if Auto Wake-up on timeout (periodic wake-up timer) is enabled
+ *  @return true if Auto Wake-up on timeout is enabled
+ */
+bool BMA400::GetAutoWakeupOnTimeout()
+{
+    return (read(BMA400_REG_AUTO_WAKEUP_1) & 0x04) == 0x04;
+}
 
-    case interrupt_source_t::BAS_WAKEUP:
-        switch (pin)
-        {
+/*!
+ *  @brief  Checking if Auto Wake-up on wake-up interrupt (motion) is enabled
+ *  @return true if the wake-up interrupt is enabled
+ */
+bool BMA400::GetAutoWakeupOnInterrupt()
+{
+    return (read(BMA400_REG_AUTO_WAKEUP_1) & 0x02) == 0x02;
+}
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 0);
-            unset(BMA400_REG_INT2_MAP, 0);
-            break;
+/*!
+ *  @brief  Getting Auto Wake-up timeout threshold (time) in ms
+ *  @return threshold in ms scale
+ */
+float BMA400::GetAutoWakeupTimeoutThreshold()
+{
+    float threshold;
+    threshold = (read(BMA400_REG_AUTO_WAKEUP_1) & 0xF0) >> 4;
+    threshold += read(BMA400_REG_AUTO_WAKEUP_0) << 4;
+    threshold *= 2.5;
+    return threshold;
+}
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 0);
-            unset(BMA400_REG_INT2_MAP, 0);
-            break;
+/*!
+ *  @brief  Configuring the Auto Wake-up timer. The sensor switches from low power to normal mode once the timer expires
+ *  @param  onTimeout enables Auto Wake-up on timeout
+ *  @param  timeout_threshold threshold in ms scale (2.5ms resolution, up to 10237.5ms)
+ */
+void BMA400::ConfigureAutoWakeup(bool onTimeout, float timeout_threshold)
+{
+    uint16_t ticks = timeout_threshold > 10237.5 ? 0x0FFF : (uint16_t)round(timeout_threshold / 2.5);
+    uint8_t val = (ticks & 0x0F) << 4;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 0);
-            set(BMA400_REG_INT2_MAP, 0);
-            break;
+    if (onTimeout)
+        val |= 0x04;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 0);
-            set(BMA400_REG_INT2_MAP, 0);
-            break;
-        }
-        break;
+    write(BMA400_REG_AUTO_WAKEUP_0, (uint8_t)(ticks >> 4));
+    write(BMA400_REG_AUTO_WAKEUP_1, val, 0x02); //# keeping the wake-up interrupt enable bit
+}
 
-    case interrupt_source_t::ADV_GENERIC_INTERRUPT_1:
-        switch (pin)
-        {
+/*!
+ *  @brief  Configures the wake-up interrupt. It is evaluated in low power mode and switches the sensor to normal mode on motion
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  reference mode of updating reference acceleration. see wakeup_reference_update_t
+ *  @param  threshold threshold (raw value) compared against the 8 MSBs of the acceleration data - LSB depends on the range (15.6mg at 2G)
+ *  @param  samples number of consecutive samples (1 to 8) above the threshold needed to wake up
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ */
+void BMA400::ConfigureWakeupInterrupt(
+    bool enable,
+    interrupt_pin_t pin,
+    wakeup_reference_update_t reference,
+    uint8_t threshold, uint8_t samples,
+    bool enableX, bool enableY, bool enableZ)
+{
+    if (!enable) //# Just disable the interrupt
+    {
+        unset(BMA400_REG_AUTO_WAKEUP_1, 1);
+        return;
+    }
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 2);
-            unset(BMA400_REG_INT2_MAP, 2);
-            break;
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt_source_t::BAS_WAKEUP, pin);
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 2);
-            unset(BMA400_REG_INT2_MAP, 2);
-            break;
+    uint8_t val = 0;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 2);
-            set(BMA400_REG_INT2_MAP, 2);
-            break;
+    switch (reference)
+    {
+    case wakeup_reference_update_t::WAKEUP_UPDATE_MANUAL:
+        // Do nothing
+        break;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 2);
-            set(BMA400_REG_INT2_MAP, 2);
-            break;
-        }
+    case wakeup_reference_update_t::WAKEUP_UPDATE_ONETIME:
+        val |= 0x01;
         break;
 
-    case interrupt_source_t::ADV_GENERIC_INTERRUPT_2:
-        switch (pin)
-        {
+    case wakeup_reference_update_t::WAKEUP_UPDATE_EVERYTIME:
+        val |= 0x02;
+        break;
+    }
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 3);
-            unset(BMA400_REG_INT2_MAP, 3);
-            break;
+    if (samples < 1)
+        samples = 1;
+    else if (samples > 8)
+        samples = 8;
+    val |= (samples - 1) << 2;
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 3);
-            unset(BMA400_REG_INT2_MAP, 3);
-            break;
+    if (enableX)
+        val |= 0x20;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 3);
-            set(BMA400_REG_INT2_MAP, 3);
-            break;
+    if (enableY)
+        val |= 0x40;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 3);
-            set(BMA400_REG_INT2_MAP, 3);
-            break;
-        }
-        break;
+    if (enableZ)
+        val |= 0x80;
 
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE:
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE_X:
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Y:
-    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Z:
-        switch (pin)
-        {
+    write(BMA400_REG_WKUP_INT_CONFIG_0, val);
+    write(BMA400_REG_WKUP_INT_CONFIG_1, threshold);
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT1_MAP, 1);
-            unset(BMA400_REG_INT2_MAP, 1);
-            break;
+    //# enabling interrupt
+    set(BMA400_REG_AUTO_WAKEUP_1, 1);
+}
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT1_MAP, 1);
-            unset(BMA400_REG_INT2_MAP, 1);
-            break;
+/*!
+ *  @brief  Configures the wake-up interrupt. It is evaluated in low power mode and switches the sensor to normal mode on motion
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  reference mode of updating reference acceleration. see wakeup_reference_update_t
+ *  @param  threshold threshold - in mg (converted using the current range)
+ *  @param  samples number of consecutive samples (1 to 8) above the threshold needed to wake up
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ */
+void BMA400::ConfigureWakeupInterrupt(
+    bool enable,
+    interrupt_pin_t pin,
+    wakeup_reference_update_t reference,
+    float threshold, uint8_t samples,
+    bool enableX, bool enableY, bool enableZ)
+{
+    float resolution = 16000.0 / GetRateDescriptor().lsb_per_g; //# mg per LSB of the 8 MSBs
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT1_MAP, 1);
-            set(BMA400_REG_INT2_MAP, 1);
-            break;
+    threshold = round(threshold / resolution);
+    ConfigureWakeupInterrupt(enable, pin, reference,
+                             (uint8_t)(threshold > 255 ? 255 : threshold), samples,
+                             enableX, enableY, enableZ);
+}
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT1_MAP, 1);
-            set(BMA400_REG_INT2_MAP, 1);
-            break;
-        }
-        break;
+/*!
+ *  @brief  Manually updating the wake-up interrupt reference acceleration
+ *  @param  values 8 MSBs of the reference acceleration in order of X Y Z (same scale as the wake-up threshold)
+ */
+void BMA400::SetWakeupReference(int8_t *values)
+{
+    write(BMA400_REG_WKUP_INT_CONFIG_2, 3, (uint8_t *)values);
+}
 
-    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER:
-    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP:
-        switch (pin)
-        {
+/*!
+ *  @brief  Use current acceleration values to Manually updating the wake-up interrupt reference acceleration
+ */
+void BMA400::SetWakeupReference()
+{
+    uint8_t data[6] = {0};
+    read(BMA400_REG_ACC_DATA, 6, data);
+    for (uint8_t i = 0; i < 3; i++)
+        data[i] = (data[i * 2] >> 4) | (data[i * 2 + 1] << 4);
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT12_MAP, 0);
-            unset(BMA400_REG_INT12_MAP, 4);
-            break;
+    write(BMA400_REG_WKUP_INT_CONFIG_2, 3, data);
+}
+
+/*!
+ *  @brief  Updating the data rate
+ *  @param  rate data rate select one between 16 rates. see output_data_rate_t for more details
+ */
+void BMA400::SetDataRate(output_data_rate_t rate)
+{
+    switch (rate)
+    {
+    case output_data_rate_t::Filter1_048x_800Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x0B, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_800Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x0B, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_048x_400Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x0A, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_400Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x0A, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_048x_200Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x09, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_200Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x09, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_048x_100Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x08, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_100Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x08, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_048x_50Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x07, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_50Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x07, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_048x_25Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x06, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_25Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x06, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_048x_12Hz:
+        unset(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x05, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter1_024x_12Hz:
+        set(BMA400_REG_ACC_CONFIG_0, 7);
+        write(BMA400_REG_ACC_CONFIG_1, 0x05, 0xF0);
+        write(BMA400_REG_ACC_CONFIG_2, 0x00, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter2_100Hz:
+        write(BMA400_REG_ACC_CONFIG_2, 0x04, 0xF3);
+        break;
+
+    case output_data_rate_t::Filter2_100Hz_LPF_1Hz:
+        write(BMA400_REG_ACC_CONFIG_2, 0x08, 0xF3);
+        break;
+
+    default:
+        return;
+    }
+
+    if (rate_descriptor_valid)
+        setRateDescriptor(rate, rate_descriptor.range);
+}
+
+/*!
+ *  @brief  Getting the data rate
+ *  @return  data rate (16 rates). see output_data_rate_t for more details
+ */
+BMA400::output_data_rate_t BMA400::GetDataRate()
+{
+    uint8_t val = read(BMA400_REG_ACC_CONFIG_2);
+
+    if (val == 0x04)
+        return output_data_rate_t::Filter2_100Hz;
+    else if (val == 0x08)
+        return output_data_rate_t::Filter2_100Hz_LPF_1Hz;
+
+    val = read(BMA400_REG_ACC_CONFIG_1) & 0x0F;
+    bool is24x = (read(BMA400_REG_ACC_CONFIG_0) & 0x80) == 0x80;
+
+    if (val >= 0x0B)
+        return is24x ? output_data_rate_t::Filter1_024x_800Hz : output_data_rate_t::Filter1_048x_800Hz;
+    else if (val <= 0x05)
+        return is24x ? output_data_rate_t::Filter1_024x_12Hz : output_data_rate_t::Filter1_048x_12Hz;
+
+    switch (val)
+    {
+    case 0x0A:
+        return is24x ? output_data_rate_t::Filter1_024x_400Hz : output_data_rate_t::Filter1_048x_400Hz;
+
+    case 0x09:
+        return is24x ? output_data_rate_t::Filter1_024x_200Hz : output_data_rate_t::Filter1_048x_200Hz;
+
+    case 0x08:
+        return is24x ? output_data_rate_t::Filter1_024x_100Hz : output_data_rate_t::Filter1_048x_100Hz;
+
+    case 0x07:
+        return is24x ? output_data_rate_t::Filter1_024x_50Hz : output_data_rate_t::Filter1_048x_50Hz;
+
+    case 0x06:
+        return is24x ? output_data_rate_t::Filter1_024x_25Hz : output_data_rate_t::Filter1_048x_25Hz;
+    }
+
+    return output_data_rate_t::UNKNOWN_RATE;
+}
+
+/*!
+ *  @brief  Updating the sampling range
+ *  @param  range sampling range 2, 4, 8, 16G. Use acceleation_range_t data type
+ */
+void BMA400::SetRange(acceleation_range_t range)
+{
+    switch (range)
+    {
+    case acceleation_range_t::RANGE_2G:
+        write(BMA400_REG_ACC_CONFIG_1, 0x00, 0x3F);
+        break;
+
+    case acceleation_range_t::RANGE_4G:
+        write(BMA400_REG_ACC_CONFIG_1, 0x40, 0x3F);
+        break;
+
+    case acceleation_range_t::RANGE_8G:
+        write(BMA400_REG_ACC_CONFIG_1, 0x80, 0x3F);
+        break;
+
+    case acceleation_range_t::RANGE_16G:
+        write(BMA400_REG_ACC_CONFIG_1, 0xC0, 0x3F);
+        break;
+
+    default:
+        return;
+    }
+
+    if (rate_descriptor_valid)
+        setRateDescriptor(rate_descriptor.rate, range);
+}
+
+/*!
+ *  @brief  Getting the sampling range
+ *  @return sampling range 2, 4, 8, 16G acceleation_range_t data type
+ */
+BMA400::acceleation_range_t BMA400::GetRange()
+{
+    switch (read(BMA400_REG_ACC_CONFIG_1) & 0xC0)
+    {
+    case 0x00:
+        return acceleation_range_t::RANGE_2G;
+
+    case 0x40:
+        return acceleation_range_t::RANGE_4G;
+
+    case 0x80:
+        return acceleation_range_t::RANGE_8G;
+
+    case 0xC0:
+        return acceleation_range_t::RANGE_16G;
+    }
+
+    return acceleation_range_t::UNKNOWN_RANGE;
+}
+
+/*!
+ *  @brief  Getting the data rate and range in physical units (frequency, period, bandwidth, LSB per g).
+ *          The descriptor is read from the sensor once and then kept up to date by SetDataRate/SetRange
+ *          (including the automatic ODR increase of the interrupt functions), so it costs no bus traffic
+ *  @return cached descriptor
+ */
+const BMA400::rate_descriptor_t &BMA400::GetRateDescriptor()
+{
+    if (!rate_descriptor_valid)
+        RefreshRateDescriptor();
+    return rate_descriptor;
+}
+
+/*!
+ *  @brief  Reloading the cached data rate and range from the sensor, e.g. after the sensor was reset
+ *          or configured by other code. Writes through WriteRegisters/QueueWrite/QueueUpdate do it automatically
+ */
+void BMA400::RefreshRateDescriptor()
+{
+    setRateDescriptor(GetDataRate(), GetRange());
+}
+
+/*!
+ *  @brief  Getting the output data rate of a data rate setting without a sensor (e.g. for estimations)
+ *  @param  rate data rate setting
+ *  @return output data rate in Hz
+ */
+float BMA400::GetRateFrequency(output_data_rate_t rate)
+{
+    return BMA400_RATES[rate].frequency;
+}
+
+/*!
+ *  @brief  Configuring the FIFO frame format and behavior
+ *  @param  enableX stores X axis into the FIFO
+ *  @param  enableY stores Y axis into the FIFO
+ *  @param  enableZ stores Z axis into the FIFO
+ *  @param  use8bit stores only the 8 MSBs of each axis (halves the bytes to read)
+ *  @param  data_source acc filt 1 (configured ODR) or acc filt 2 (fixed 100Hz)
+ *  @param  stopOnFull if true new samples are dropped once the FIFO is full, otherwise the oldest samples are overwritten
+ *  @param  enableTime appends a sensor time frame when the FIFO is read empty
+ *  @param  autoFlush flushes the FIFO when switching the power mode
+ */
+void BMA400::ConfigureFifo(
+    bool enableX, bool enableY, bool enableZ,
+    bool use8bit,
+    interrupt_data_source_t data_source,
+    bool stopOnFull,
+    bool enableTime,
+    bool autoFlush)
+{
+    uint8_t val = 0;
+
+    if (autoFlush)
+        val |= 0x01;
+
+    if (stopOnFull)
+        val |= 0x02;
+
+    if (enableTime)
+        val |= 0x04;
+
+    if (data_source == interrupt_data_source_t::ACC_FILT_2)
+        val |= 0x08;
+
+    if (use8bit)
+        val |= 0x10;
+
+    if (enableX)
+        val |= 0x20;
+
+    if (enableY)
+        val |= 0x40;
+
+    if (enableZ)
+        val |= 0x80;
+
+    write(BMA400_REG_FIFO_CONFIG_0, val);
+
+    fifo_frame_size = 1 + (enableX + enableY + enableZ) * (use8bit ? 1 : 2);
+    fifo_time_enabled = enableTime;
+}
+
+/*!
+ *  @brief  Updating the FIFO watermark level
+ *  @param  level FIFO fill level in bytes (up to 1023) that triggers the FIFO watermark interrupt
+ */
+void BMA400::SetFifoWatermark(uint16_t level)
+{
+    if (level >= BMA400_FIFO_SIZE)
+        level = BMA400_FIFO_SIZE - 1;
+
+    write(BMA400_REG_FIFO_CONFIG_1, (uint8_t)level);
+    write(BMA400_REG_FIFO_CONFIG_2, (uint8_t)(level >> 8) & 0x07);
+}
+
+/*!
+ *  @brief  Getting the FIFO watermark level
+ *  @return FIFO fill level in bytes that triggers the FIFO watermark interrupt
+ */
+uint16_t BMA400::GetFifoWatermark()
+{
+    uint8_t values[2] = {0};
+    read(BMA400_REG_FIFO_CONFIG_1, 2, values);
+    return values[0] + (values[1] & 0x07) * 256;
+}
+
+/*!
+ *  @brief  Getting the number of bytes stored in the FIFO
+ *  @return FIFO fill level in bytes
+ */
+uint16_t BMA400::GetFifoLength()
+{
+    uint8_t values[2] = {0};
+    read(BMA400_REG_FIFO_LENGTH_0, 2, values);
+    return values[0] + (values[1] & 0x07) * 256;
+}
+
+/*!
+ *  @brief  Clearing all data in the FIFO
+ *  @return true if the command is sent successfully
+ */
+bool BMA400::FlushFifo()
+{
+    return ExecuteCommand(command_t::CMD_FIFO_FLUSH);
+}
+
+/*!
+ *  @brief  Reading (draining) samples from the FIFO - unprocessed
+ *  @param  values address of an array (int16_t) with at least 3 x max_samples elements. samples are stored as X Y Z X Y Z ...
+ * axes not stored in the FIFO are set to 0. 8 bit samples are scaled to the 12 bit range
+ *  @param  max_samples maximum number of samples to read
+ *  @param  sensor_time if not null receives the sensor time (LSB = 312.5us) when the time frame is enabled and the FIFO was read empty
+ *  @return number of samples read
+ */
+uint16_t BMA400::ReadFifo(int16_t *values, uint16_t max_samples, uint32_t *sensor_time)
+{
+    uint16_t remaining = GetFifoLength();
+    if (remaining == 0 || max_samples == 0)
+        return 0;
+
+    //# reading only what fits into values, the rest stays in the FIFO
+    if ((uint32_t)max_samples * fifo_frame_size < remaining)
+        remaining = max_samples * fifo_frame_size;
+    else if (fifo_time_enabled)
+        remaining += 4; //# sensor time frame is appended once the FIFO is empty
+
+    //# whole frames per transaction, as many as the bus and the buffer allow
+    uint16_t chunk = GetMaxTransferSize();
+    if (chunk > BMA400_FIFO_BUFFER_SIZE)
+        chunk = BMA400_FIFO_BUFFER_SIZE;
+    if (chunk > fifo_frame_size)
+        chunk -= chunk % fifo_frame_size;
+
+    uint8_t buffer[BMA400_FIFO_BUFFER_SIZE + 7];
+    uint16_t pending = 0;
+    uint16_t count = 0;
+    bool end = false;
+
+    while (remaining > 0 && count < max_samples && !end)
+    {
+        uint16_t length = remaining > chunk ? chunk : remaining;
+        if (read(BMA400_REG_FIFO_DATA, length, buffer + pending) != bus_status_t::BUS_OK)
+            break; //# only the samples decoded so far, the error is kept for GetLastBusStatus
+        remaining -= length;
+        pending += length;
+
+        uint16_t consumed = 0;
+        count += decodeFifo(buffer, pending, values + count * 3, max_samples - count, sensor_time, consumed, end);
+
+        //# keeping an incomplete frame for the next chunk
+        pending -= consumed;
+        memmove(buffer, buffer + consumed, pending);
+    }
+
+    return count;
+}
+
+/*!
+ *  @brief  Reading (draining) the FIFO straight into a caller owned block, without a staging buffer:
+ *          the raw frames are read into the unused tail of the block and decoded in place.
+ *          Samples are appended after the ones already stored
+ *  @param  block block to fill, e.g. from BMA400BufferPool::Acquire
+ *  @return number of samples added. Frames not fitting into the block stay in the FIFO
+ */
+uint16_t BMA400::ReadFifo(sample_block_t &block)
+{
+    fifo_drain_t drain;
+    uint16_t first = block.count;
+
+    if (startFifoDrain(block, drain, GetFifoLength()))
+        while (stepFifoDrain(block, drain) == bus_status_t::BUS_OK && isFifoDrainPending(block, drain))
+            ;
+
+    return block.count - first;
+}
+
+/*!
+ *  @brief  Dropping the oldest FIFO frames until the FIFO holds at most the given number of samples.
+ *          The fill level is read again after every chunk, so samples arriving meanwhile are dropped too
+ *  @param  samples number of newest samples to keep
+ *  @return number of samples left in the FIFO (at the last fill level read)
+ */
+uint16_t BMA400::TrimFifo(uint16_t samples)
+{
+    uint8_t buffer[8 * 7 + 7];
+    int16_t scratch[8 * 3];
+
+    for (;;)
+    {
+        uint16_t stored = GetFifoLength() / fifo_frame_size;
+        if (stored <= samples)
+            return stored;
+
+        uint16_t length = (stored - samples > 8 ? 8 : stored - samples) * fifo_frame_size;
+        if (read(BMA400_REG_FIFO_DATA, length, buffer) != bus_status_t::BUS_OK)
+            return stored;
+
+        //# completing a frame cut by a control frame, so the next read starts at a frame header
+        uint16_t consumed = 0;
+        bool end = false;
+        decodeFifo(buffer, length, scratch, 8, nullptr, consumed, end);
+        if (!end && consumed < length)
+        {
+            uint8_t missing = getFifoFrameSize(buffer[consumed]) - (length - consumed);
+            if (read(BMA400_REG_FIFO_DATA, missing, buffer + length) != bus_status_t::BUS_OK)
+                return stored;
+        }
+    }
+}
+
+/*!
+ *  @brief  Queuing a FIFO drain into a block for cooperative (non-blocking) mode (see ReadFifo with a block).
+ *          Poll reads the FIFO length, then one chunk per call
+ *  @param  block block to fill. must stay valid until the operation completes
+ *  @param  callback called (from Poll) once the block is full or the FIFO is drained. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the queue is full
+ */
+bool BMA400::QueueReadFifo(sample_block_t &block, operation_callback_t callback, void *context)
+{
+    operation_t *op = enqueue(operation_type_t::OP_READ_FIFO, BMA400_REG_FIFO_LENGTH_0, callback, context);
+    if (op == nullptr)
+        return false;
+    op->destination = &block;
+    return true;
+}
+
+/*!
+ *  @brief  Getting the number of FIFO drains that found the FIFO full, i.e. samples were lost
+ *          (or, with stop on full, not stored). The FIFO is drained too late when this increases
+ *  @return number of overruns
+ */
+uint32_t BMA400::GetFifoOverruns()
+{
+    return fifo_overruns;
+}
+
+/*!
+ *  @brief  Clearing the FIFO overrun counter
+ */
+void BMA400::ResetFifoOverruns()
+{
+    fifo_overruns = 0;
+}
+
+/*!
+ *  @brief  Configuring the FIFO for batched reads: picks the watermark and frame format from the maximum latency
+ *  and the data rate, so the MCU wakes up once per batch on the FIFO watermark interrupt
+ *  @param  max_latency maximum time (ms) a sample may wait in the FIFO before being read
+ *  @param  resolution required resolution in mg. 8 bit frames are used if the 8 bit resolution at the current range is fine enough. 0 forces 12 bit frames
+ *  @param  pin wires the FIFO watermark interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  enableX stores X axis into the FIFO
+ *  @param  enableY stores Y axis into the FIFO
+ *  @param  enableZ stores Z axis into the FIFO
+ *  @param  data_source acc filt 1 (configured ODR) or acc filt 2 (fixed 100Hz)
+ *  @return number of samples per batch
+ */
+uint16_t BMA400::ConfigureFifoBatching(
+    float max_latency,
+    float resolution,
+    interrupt_pin_t pin,
+    bool enableX, bool enableY, bool enableZ,
+    interrupt_data_source_t data_source)
+{
+    const rate_descriptor_t &descriptor = GetRateDescriptor();
+    float rate = data_source == interrupt_data_source_t::ACC_FILT_2 ? 100 : descriptor.frequency;
+    float resolution_8bit = 16000.0 / descriptor.lsb_per_g; //# mg per LSB of the 8 MSBs
+
+    bool use8bit = resolution > 0 && resolution >= resolution_8bit;
+    uint8_t frame_size = 1 + (enableX + enableY + enableZ) * (use8bit ? 1 : 2);
+
+    //# leaving room for a few more frames arriving while the interrupt is served
+    uint16_t max_frames = (BMA400_FIFO_SIZE - 1) / frame_size - 4;
+    float frames = floor(max_latency * rate / 1000);
+    uint16_t batch = frames < 1 ? 1 : frames > max_frames ? max_frames : (uint16_t)frames;
+
+    ConfigureFifo(enableX, enableY, enableZ, use8bit, data_source);
+    SetFifoWatermark(batch * frame_size);
+    FlushFifo();
+    ConfigureBasicInterrupts(interrupt_source_t::BAS_FIFO_WATERMARK, true, pin);
+
+    return batch;
+}
+
+/*!
+ *  @brief  Getting the sensor time
+ *  @return sensor time (24 bit counter) - LSB = 312.5us
+ */
+uint32_t BMA400::GetSensorTime()
+{
+    uint8_t values[3] = {0};
+    read(BMA400_REG_SENSOR_TIME_0, 3, values);
+    return values[0] + values[1] * 256 + (uint32_t)values[2] * 256 * 256;
+}
+
+/*!
+ *  @brief  Configuring the FIFO as a history buffer for pre-trigger capture. The FIFO keeps streaming
+ * (oldest samples are overwritten) and the MCU does not need to read anything until an event occurs.
+ * Sensor time frames are enabled to timestamp the captured samples
+ *  @param  use8bit stores only the 8 MSBs of each axis (doubles the history length)
+ *  @param  data_source acc filt 1 (configured ODR) or acc filt 2 (fixed 100Hz)
+ *  @return maximum number of samples kept in the history
+ */
+uint16_t BMA400::ConfigurePreTriggerCapture(bool use8bit, interrupt_data_source_t data_source)
+{
+    capture_rate = data_source == interrupt_data_source_t::ACC_FILT_2 ? 100 : GetRateDescriptor().frequency;
+
+    //# no FIFO interrupts, the event interrupt (e.g. generic interrupt 1) triggers the capture
+    DisableInterrupts(interrupt_source_t::BAS_FIFO_WATERMARK);
+    DisableInterrupts(interrupt_source_t::BAS_FIFO_FULL);
+
+    ConfigureFifo(true, true, true, use8bit, data_source, false, true);
+    FlushFifo();
+
+    return BMA400_FIFO_SIZE / fifo_frame_size;
+}
+
+/*!
+ *  @brief  Capturing a window of samples around an event. Call it as soon as the event interrupt is served.
+ * The samples stored before the call are the pre-trigger samples, then it waits for the post-trigger samples.
+ * The samples are timestamped from the FIFO sensor time frame, so samples arriving while the history is
+ * read are counted as post-trigger samples
+ *  @param  values address of an array (int16_t) with at least 3 x (pre_samples + post_samples) elements. samples are stored as X Y Z X Y Z ...
+ *  @param  timestamps if not null address of an array with at least (pre_samples + post_samples) elements receiving the sensor time of each sample (LSB = 312.5us)
+ *  @param  pre_samples number of samples before the trigger
+ *  @param  post_samples number of samples after the trigger
+ *  @param  trigger_index receives the index of the first post-trigger sample (less than pre_samples if the history was shorter)
+ *  @param  timeout maximum time (ms) to wait for the post-trigger samples
+ *  @return number of samples captured
+ */
+uint16_t BMA400::CapturePreTriggerWindow(
+    int16_t *values, uint32_t *timestamps,
+    uint16_t pre_samples, uint16_t post_samples,
+    uint16_t &trigger_index,
+    uint16_t timeout)
+{
+    uint32_t trigger_time = GetSensorTime();
+    uint32_t period = (uint32_t)round(3200 / capture_rate); //# sensor time ticks per sample (a power of 2)
+
+    //# the newest history that fits, read until the FIFO is empty so the time frame stamps the last sample
+    TrimFifo(pre_samples + post_samples);
+    uint32_t read_time = 0xFFFFFFFF;
+    uint16_t count = ReadFifo(values, pre_samples + post_samples, &read_time);
+    uint16_t behind = 0;
+    if (read_time == 0xFFFFFFFF) //# more samples arrived than fit, no time frame: the newest ones are still stored
+    {
+        behind = GetFifoLength() / fifo_frame_size;
+        read_time = GetSensorTime();
+    }
+    uint32_t first_time = read_time - read_time % period - ((uint32_t)behind + count - 1) * period;
+
+    //# samples after the trigger (sensor time is a 24 bit counter)
+    uint32_t ahead = (first_time + (count - 1) * period - trigger_time) & 0x00FFFFFF;
+    uint16_t after = ahead >= 0x800000 ? 0 : (ahead + period - 1) / period;
+    if (after > count)
+        after = count;
+
+    //# dropping the history older than needed
+    if (count - after > pre_samples)
+    {
+        uint16_t drop = count - after - pre_samples;
+        memmove(values, values + drop * 3, (count - drop) * 3 * sizeof(int16_t));
+        count -= drop;
+        first_time += drop * period;
+    }
+    trigger_index = count - after;
+    if (after > post_samples)
+        count = trigger_index + post_samples;
+
+    //# waiting for the rest of the post-trigger samples, they follow the ones read without a gap
+    uint16_t missing = trigger_index + post_samples - count;
+    if (missing > 0)
+    {
+        uint16_t needed = missing * fifo_frame_size;
+        uint32_t start = millis();
+        while (GetFifoLength() < needed && millis() - start < timeout)
+            delay(1 + (uint32_t)(1000 / capture_rate) / 2);
+
+        count += ReadFifo(values + count * 3, missing);
+    }
+
+    if (timestamps != nullptr)
+        for (uint16_t i = 0; i < count; i++)
+            timestamps[i] = (first_time + i * period) & 0x00FFFFFF;
+
+    return count;
+}
+
+/*!
+ *  @brief  Getting all triggered interrupts
+ *  @return combination of all interrupts if there is more than one
+ */
+BMA400::interrupt_source_t BMA400::GetInterrupts()
+{
+    uint8_t interrupts[3] = {0};
+    read(BMA400_REG_INT_STAT_0, 3, interrupts);
+#if defined(BMA400_TELEMETRY)
+    interrupt_source_t result = decodeInterrupts(interrupts);
+    recordInterrupts(result);
+    return result;
+#else
+    return decodeInterrupts(interrupts);
+#endif
+}
+
+/*!
+ *  @brief  Checks if an specific interrupt is rised after reading all interrupts blindly.
+ *  Not a good idea to use this method if you enabled multiple interrupts
+ *  @return true if the target interrupt is triggered
+ */
+bool BMA400::HasInterrupt(interrupt_source_t source)
+{
+    return (bool)(GetInterrupts() & source);
+}
+
+/*!
+ *  @brief  Disabling Interrupts
+ *  @param  source Interrupt source. use ALL_INTERRUPTS to disable all interrupts (very usefull if don't know which interrupts are active)
+ *  @param  enable true to enable interrupt
+ */
+void BMA400::DisableInterrupts(interrupt_source_t source)
+{
+    switch (source)
+    {
+    case interrupt_source_t::ALL_INTERRUPTS:
+        write(BMA400_REG_INT_CONFIG_0, 0);
+        write(BMA400_REG_INT_CONFIG_1, 0);
+        unset(BMA400_REG_AUTO_WAKEUP_1, 1);
+        break;
+
+    case interrupt_source_t::BAS_WAKEUP:
+        unset(BMA400_REG_AUTO_WAKEUP_1, 1);
+        break;
+
+    case interrupt_source_t::BAS_DATA_READY:
+        unset(BMA400_REG_INT_CONFIG_0, 7);
+        break;
+
+    case interrupt_source_t::BAS_FIFO_WATERMARK:
+        unset(BMA400_REG_INT_CONFIG_0, 6);
+        break;
+
+    case interrupt_source_t::BAS_FIFO_FULL:
+        unset(BMA400_REG_INT_CONFIG_0, 5);
+        break;
+
+    case interrupt_source_t::ADV_GENERIC_INTERRUPT_2:
+        unset(BMA400_REG_INT_CONFIG_0, 4);
+        break;
+
+    case interrupt_source_t::ADV_GENERIC_INTERRUPT_1:
+        unset(BMA400_REG_INT_CONFIG_0, 3);
+        break;
+
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE:
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE_X:
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Y:
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Z:
+        unset(BMA400_REG_INT_CONFIG_0, 2);
+        break;
+
+    case interrupt_source_t::ADV_ACTIVITY_CHANGE:
+        unset(BMA400_REG_INT_CONFIG_1, 4);
+        break;
+
+    case interrupt_source_t::ADV_DOUBLE_TAP:
+        unset(BMA400_REG_INT_CONFIG_0, 3);
+        break;
+
+    case interrupt_source_t::ADV_SINGLE_TAP:
+        unset(BMA400_REG_INT_CONFIG_0, 2);
+        break;
+
+    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER:
+    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP:
+        unset(BMA400_REG_INT_CONFIG_0, 0);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/*!
+ *  @brief  Enabling/Disabling Basic Interrupts
+ *  @param  source Interrupt source. can be either Data Ready, FIFO Full or FIFO Watermark
+ *  @param  enable true to enable interrupt
+ */
+void BMA400::ConfigureBasicInterrupts(interrupt_source_t source, bool enable)
+{
+    switch (source)
+    {
+    case interrupt_source_t::BAS_DATA_READY:
+        if (enable)
+            set(BMA400_REG_INT_CONFIG_0, 7);
+        else
+            unset(BMA400_REG_INT_CONFIG_0, 7);
+        break;
+
+    case interrupt_source_t::BAS_FIFO_WATERMARK:
+        if (enable)
+            set(BMA400_REG_INT_CONFIG_0, 6);
+        else
+            unset(BMA400_REG_INT_CONFIG_0, 6);
+        break;
+
+    case interrupt_source_t::BAS_FIFO_FULL:
+        if (enable)
+            set(BMA400_REG_INT_CONFIG_0, 5);
+        else
+            unset(BMA400_REG_INT_CONFIG_0, 5);
+        break;
+
+    default:
+        // Ignore the rest
+        break;
+    }
+}
+
+/*!
+ *  @brief  Configure Basic Interrupts (Enabling/Disabling & Linking to Interrupt Pins)
+ *  @param  source Interrupt source. can be either Data Ready, FIFO Full or FIFO Watermark
+ *  @param  enable true to enable interrupt
+ *  @param  pin target interrupt pin. see interrupt_pin_t for more detail
+ */
+void BMA400::ConfigureBasicInterrupts(interrupt_source_t source, bool enable, interrupt_pin_t pin)
+{
+    ConfigureBasicInterrupts(source, enable);
+    LinkToInterruptPin(source, pin);
+}
+
+/*!
+ *  @brief  Configuring electrical behavior of interrupt pins
+ *  @param  isLatched set true to enable latched (hold) interrupt. In latch mode interrupt stays active until reading the corresponding interrupt register is read.
+ *  @param  isINT1_active_hi set true to set interrupt pin 1 active mode to high level (pull up), otherwise it's pulled down when active
+ *  @param  isINT2_active_hi set true to set interrupt pin 1 active mode to high level (pull up), otherwise it's pulled down when active
+ *  @param  isINT1_open_drive set true to enable open drive mode for Interrupt Pin 1, otherwise it is using push pull electrical drive
+ *  @param  isINT2_open_drive set true to enable open drive mode for Interrupt Pin 1, otherwise it is using push pull electrical drive
+ */
+void BMA400::ConfigureInterruptPinSettings(
+    bool isLatched,
+    bool isINT1_active_hi,
+    bool isINT2_active_hi,
+    bool isINT1_open_drive,
+    bool isINT2_open_drive)
+{
+    if (isLatched)
+        set(BMA400_REG_INT_CONFIG_1, 7);
+    else
+        unset(BMA400_REG_INT_CONFIG_1, 7);
+
+    uint8_t val = 0;
+
+    if (isINT1_active_hi)
+        val |= 0x02;
+
+    if (isINT2_active_hi)
+        val |= 0x20;
+
+    if (isINT1_open_drive)
+        val |= 0x04;
+
+    if (isINT2_open_drive)
+        val |= 0x40;
+
+    write(BMA400_REG_INT_IO_CTRL, val);
+}
+
+/*!
+ *  @brief  Links/unlinks an interrupt source to/from interrupt pins
+ *  @param  interrupt Interrupt source (can be any interrupt source)
+ *  @param  pin target pin(s) should be linked to the interrupt source. can either, none or both
+ */
+void BMA400::LinkToInterruptPin(interrupt_source_t interrupt, interrupt_pin_t pin)
+{
+    switch (interrupt)
+    {
+    case interrupt_source_t::BAS_DATA_READY:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 7);
+            unset(BMA400_REG_INT2_MAP, 7);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 7);
+            unset(BMA400_REG_INT2_MAP, 7);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 7);
+            set(BMA400_REG_INT2_MAP, 7);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 7);
+            set(BMA400_REG_INT2_MAP, 7);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::BAS_FIFO_WATERMARK:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 6);
+            unset(BMA400_REG_INT2_MAP, 6);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 6);
+            unset(BMA400_REG_INT2_MAP, 6);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 6);
+            set(BMA400_REG_INT2_MAP, 6);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 6);
+            set(BMA400_REG_INT2_MAP, 6);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::BAS_FIFO_FULL:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 5);
+            unset(BMA400_REG_INT2_MAP, 5);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 5);
+            unset(BMA400_REG_INT2_MAP, 5);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 5);
+            set(BMA400_REG_INT2_MAP, 5);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 5);
+            set(BMA400_REG_INT2_MAP, 5);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::BAS_ENGINE_OVERRUN:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 4);
+            unset(BMA400_REG_INT2_MAP, 4);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 4);
+            unset(BMA400_REG_INT2_MAP, 4);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 4);
+            set(BMA400_REG_INT2_MAP, 4);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 4);
+            set(BMA400_REG_INT2_MAP, 4);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::BAS_WAKEUP:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 0);
+            unset(BMA400_REG_INT2_MAP, 0);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 0);
+            unset(BMA400_REG_INT2_MAP, 0);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 0);
+            set(BMA400_REG_INT2_MAP, 0);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 0);
+            set(BMA400_REG_INT2_MAP, 0);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::ADV_GENERIC_INTERRUPT_1:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 2);
+            unset(BMA400_REG_INT2_MAP, 2);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 2);
+            unset(BMA400_REG_INT2_MAP, 2);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 2);
+            set(BMA400_REG_INT2_MAP, 2);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 2);
+            set(BMA400_REG_INT2_MAP, 2);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::ADV_GENERIC_INTERRUPT_2:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 3);
+            unset(BMA400_REG_INT2_MAP, 3);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 3);
+            unset(BMA400_REG_INT2_MAP, 3);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 3);
+            set(BMA400_REG_INT2_MAP, 3);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 3);
+            set(BMA400_REG_INT2_MAP, 3);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE:
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE_X:
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Y:
+    case interrupt_source_t::ADV_ORIENTATION_CHANGE_Z:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT1_MAP, 1);
+            unset(BMA400_REG_INT2_MAP, 1);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT1_MAP, 1);
+            unset(BMA400_REG_INT2_MAP, 1);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT1_MAP, 1);
+            set(BMA400_REG_INT2_MAP, 1);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT1_MAP, 1);
+            set(BMA400_REG_INT2_MAP, 1);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER:
+    case interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT12_MAP, 0);
+            unset(BMA400_REG_INT12_MAP, 4);
+            break;
 
         case interrupt_pin_t::INT_PIN_1:
             set(BMA400_REG_INT12_MAP, 0);
             unset(BMA400_REG_INT12_MAP, 4);
             break;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT12_MAP, 0);
-            set(BMA400_REG_INT12_MAP, 4);
-            break;
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT12_MAP, 0);
+            set(BMA400_REG_INT12_MAP, 4);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT12_MAP, 0);
+            set(BMA400_REG_INT12_MAP, 4);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::ADV_SINGLE_TAP:
+    case interrupt_source_t::ADV_DOUBLE_TAP:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT12_MAP, 2);
+            unset(BMA400_REG_INT12_MAP, 6);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT12_MAP, 2);
+            unset(BMA400_REG_INT12_MAP, 6);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT12_MAP, 2);
+            set(BMA400_REG_INT12_MAP, 6);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT12_MAP, 2);
+            set(BMA400_REG_INT12_MAP, 6);
+            break;
+        }
+        break;
+
+    case interrupt_source_t::ADV_ACTIVITY_CHANGE:
+        switch (pin)
+        {
+
+        case interrupt_pin_t::INT_NONE:
+            unset(BMA400_REG_INT12_MAP, 3);
+            unset(BMA400_REG_INT12_MAP, 7);
+            break;
+
+        case interrupt_pin_t::INT_PIN_1:
+            set(BMA400_REG_INT12_MAP, 3);
+            unset(BMA400_REG_INT12_MAP, 7);
+            break;
+
+        case interrupt_pin_t::INT_PIN_2:
+            unset(BMA400_REG_INT12_MAP, 3);
+            set(BMA400_REG_INT12_MAP, 7);
+            break;
+
+        case interrupt_pin_t::INT_PIN_BOTH:
+            set(BMA400_REG_INT12_MAP, 3);
+            set(BMA400_REG_INT12_MAP, 7);
+            break;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/*!
+ *  @brief  Configures Generic Interrupt 1 or 2
+ *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  reference mode of updating reference acceleration. see generic_interrupt_reference_update_t
+ *  @param  mode Interrupt mode. On Activity or On Inactivity
+ *  @param  threshold threshold (raw value) LSB = 8mg
+ *  @param  duration minimum duration can generate interrupt - (raw value) depending on ODR
+ *  @param  hystersis hystersis amplitude. can be selected between 0, 24, 48, 96mg
+ *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ *  @param  all_combined if true uses AND logic applies on all axes to generate interrupts, otherwise OR logic
+ *  @param  ignoreSamplingRateFix if false automatically increases the ODR to 100Hz if it's lower
+ */
+void BMA400::ConfigureGenericInterrupt(
+    interrupt_source_t interrupt, bool enable,
+    interrupt_pin_t pin,
+    generic_interrupt_reference_update_t reference,
+    generic_interrupt_mode_t mode,
+    uint8_t threshold,
+    uint16_t duration,
+    generic_interrupt_hysteresis_amplitude_t hystersis,
+    interrupt_data_source_t data_source,
+    bool enableX, bool enableY, bool enableZ,
+    bool all_combined, bool ignoreSamplingRateFix)
+{
+    if ((interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_1) &
+        (interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_2)) //# ignore if not a generic interrupt
+        return;
+    if (!enable) //# just disable the interrupt
+    {
+        unset(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
+        return;
+    }
+
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt, pin);
+
+    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
+
+    //# increasing the rate to be at least 100Hz
+    if (!ignoreSamplingRateFix)
+    {
+        output_data_rate_t rate = GetRateDescriptor().rate;
+        if ((rate == output_data_rate_t::Filter1_024x_12Hz) |
+            (rate == output_data_rate_t::Filter1_024x_25Hz) |
+            (rate == output_data_rate_t::Filter1_024x_50Hz))
+            SetDataRate(output_data_rate_t::Filter1_024x_100Hz);
+        else if ((rate == output_data_rate_t::Filter1_048x_12Hz) |
+                 (rate == output_data_rate_t::Filter1_048x_25Hz) |
+                 (rate == output_data_rate_t::Filter1_048x_50Hz))
+            SetDataRate(output_data_rate_t::Filter1_048x_100Hz);
+    }
+
+    //# enabling interrupt
+    set(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
+
+    //# config 0 to config 4 registers in one burst
+    uint8_t config[5];
+    encodeGenericInterrupt(reference, mode, threshold, duration, hystersis, data_source,
+                           enableX, enableY, enableZ, all_combined, config);
+    write(_register, 5, config);
+}
+
+/*!
+ *  @brief  Configures Generic Interrupt 1 or 2
+ *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  reference mode of updating reference acceleration. see generic_interrupt_reference_update_t
+ *  @param  mode Interrupt mode. On Activity or On Inactivity
+ *  @param  threshold threshold - in mg
+ *  @param  duration minimum duration can generate interrupt - in mili seconds
+ *  @param  hystersis hystersis amplitude. can be selected between 0, 24, 48, 96mg
+ *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ *  @param  all_combined if true uses AND logic applies on all axes to generate interrupts, otherwise OR logic
+ *  @param  ignoreSamplingRateFix if false automatically increases the ODR to 100Hz if it's lower
+ */
+void BMA400::ConfigureGenericInterrupt(
+    interrupt_source_t interrupt, bool enable,
+    interrupt_pin_t pin,
+    generic_interrupt_reference_update_t reference,
+    generic_interrupt_mode_t mode,
+    float threshold,
+    float duration,
+    generic_interrupt_hysteresis_amplitude_t hystersis,
+    interrupt_data_source_t data_source,
+    bool enableX, bool enableY, bool enableZ,
+    bool all_combined, bool ignoreSamplingRateFix)
+{
+    if ((interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_1) &
+        (interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_2)) //# ignore if not a generic interrupt
+        return;
+    if (!enable) //# just disable the interrupt
+    {
+        unset(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
+        return;
+    }
+
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt, pin);
+
+    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
+
+    //# increasing the rate to be at least 100Hz
+    if (!ignoreSamplingRateFix)
+    {
+        output_data_rate_t rate = GetRateDescriptor().rate;
+        if ((rate == output_data_rate_t::Filter1_024x_12Hz) |
+            (rate == output_data_rate_t::Filter1_024x_25Hz) |
+            (rate == output_data_rate_t::Filter1_024x_50Hz))
+            SetDataRate(output_data_rate_t::Filter1_024x_100Hz);
+        else if ((rate == output_data_rate_t::Filter1_048x_12Hz) |
+                 (rate == output_data_rate_t::Filter1_048x_25Hz) |
+                 (rate == output_data_rate_t::Filter1_048x_50Hz))
+            SetDataRate(output_data_rate_t::Filter1_048x_100Hz);
+    }
+
+    //# enabling interrupt
+    set(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
+
+    //# mg to the 8mg LSB, ms to samples of the data source (filter 2 runs at a fixed 100Hz)
+    threshold /= 8;
+    float frequency = data_source == interrupt_data_source_t::ACC_FILT_2 ? 100 : GetRateDescriptor().frequency;
+    duration *= frequency / 1000;
+
+    //# config 0 to config 4 registers in one burst
+    uint8_t config[5];
+    encodeGenericInterrupt(reference, mode, threshold > 255 ? 255 : (uint8_t)threshold, (uint16_t)round(duration),
+                           hystersis, data_source, enableX, enableY, enableZ, all_combined, config);
+    write(_register, 5, config);
+}
+
+/*!
+ *  @brief  Manually updating the reference acceleration
+ *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
+ *  @param  values raw values in order of [0]X(MSB) [1]X(LSB) [2]Y(MSB) [2]Y(LSB) [3]Z(MSB) [3]Z(LSB) 
+ */
+void BMA400::SetGenericInterruptReference(interrupt_source_t interrupt, uint8_t *values)
+{
+    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
+    _register += 5; //# pointing to config 4
+
+    write(_register, 6, values);
+}
+
+/*!
+ *  @brief  Use current acceleration values to Manually updating the reference acceleration
+ *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
+ */
+void BMA400::SetGenericInterruptReference(interrupt_source_t interrupt)
+{
+    uint8_t data[6] = {0};
+    read(BMA400_REG_ACC_DATA, 6, data);
+    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
+    _register += 5; //# pointing to config 4
+
+    write(_register, 6, data);
+}
+
+/*!
+ *  @brief  Enabling/Disabling the step detector interrupt and step counter
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  enable true to enable the interrupt (counter)
+ */
+void BMA400::ConfigureStepDetectorCounter(bool enable, interrupt_pin_t pin)
+{
+    if (enable)
+    {
+        set(BMA400_REG_INT_CONFIG_1, 0);
+        LinkToInterruptPin(interrupt_source_t::ADV_STEP_DETECTOR_COUNTER, pin);
+    }
+    else
+        unset(BMA400_REG_INT_CONFIG_1, 0);
+}
+
+/*!
+ *  @brief  Getting the total steps counted so far. 
+ *  @return total steps counted
+ */
+uint32_t BMA400::GetTotalSteps()
+{
+    uint32_t value;
+    uint8_t values[3] = {0};
+    read(BMA400_REG_STEP_CNT0, 3, values);
+    value = values[0] + values[1] * 256 + values[2] * 256 * 256;
+    return value;
+}
+
+/*!
+ *  @brief  Reseting the total steps counted so far. 
+ *  @return true if reset step counter is successfully sent
+ */
+bool BMA400::ResetStepCounter()
+{
+    return ExecuteCommand(command_t::CMD_RESET_STEP_CNT);
+}
+
+/*!
+ *  @brief  Getting the total steps and the recognized activity in one burst (STEP_CNT0-2 & STEP_STAT)
+ *  @param  status receives the steps and activity
+ *  @return true if the registers were read
+ */
+bool BMA400::GetStepStatus(step_status_t &status)
+{
+    uint8_t values[4] = {0};
+    if (read(BMA400_REG_STEP_CNT0, 4, values) != bus_status_t::BUS_OK)
+        return false;
+    decodeStepStatus(values, status);
+    return true;
+}
+
+/*!
+ *  @brief  Getting the activity recognized by the step counter. The step counter must be enabled
+ *  @return still, walking or running
+ */
+BMA400::activity_t BMA400::GetActivity()
+{
+    uint8_t data[4] = {0, 0, 0, read(BMA400_REG_STEP_STAT)};
+    step_status_t status;
+    decodeStepStatus(data, status);
+    return status.activity;
+}
+
+/*!
+ *  @brief  Setting the function called by UpdateActivity/QueueGetStepStatus when the activity changes
+ *  @param  callback called with the previous & new activity and the total steps. nullptr disables it
+ *  @param  context passed to the callback
+ */
+void BMA400::SetActivityCallback(activity_callback_t callback, void *context)
+{
+    activity_callback = callback;
+    activity_context = context;
+}
+
+/*!
+ *  @brief  Reading steps & activity and reporting activity changes to the activity callback.
+ *  Stopping may not raise a step interrupt, so call it from time to time (or enable the activity
+ *  change interrupt) to catch going back to still
+ *  @return true if the activity changed
+ */
+bool BMA400::UpdateActivity()
+{
+    step_status_t status;
+    if (!GetStepStatus(status))
+        return false;
+    return reportActivity(status);
+}
+
+/*!
+ *  @brief  Reading steps & activity only when an activity change or step interrupt is pending
+ *  @param  interrupts decoded interrupts (see GetInterrupts)
+ *  @return true if the activity changed
+ */
+bool BMA400::UpdateActivity(interrupt_source_t interrupts)
+{
+    const uint16_t triggers = interrupt_source_t::ADV_ACTIVITY_CHANGE |
+                              interrupt_source_t::ADV_STEP_DETECTOR_COUNTER |
+                              interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP;
+    if ((interrupts & triggers) == 0)
+        return false;
+    return UpdateActivity();
+}
+
+/*!
+ *  @brief  Configures Activity change Interrupt
+ *  @param  threshold threshold - raw value
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  observation_number number of observations generates the interrupt
+ *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ */
+void BMA400::ConfigureActivityChangeInterrupt(bool enable,
+                                              interrupt_pin_t pin,
+                                              uint8_t threshold,
+                                              activity_change_observation_number_t observation_number,
+                                              interrupt_data_source_t data_source,
+                                              bool enableX, bool enableY, bool enableZ)
+{
+    if (!enable) //# Just disable the interrupt
+    {
+        unset(BMA400_REG_INT_CONFIG_1, 4);
+        return;
+    }
+
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt_source_t::ADV_ACTIVITY_CHANGE, pin);
+
+    set(BMA400_REG_INT_CONFIG_1, 4);
+    write(BMA400_REG_ACT_CHNG_INT_CONFIG_0, threshold);
+
+    uint8_t val = 0;
+
+    switch (observation_number)
+    {
+    case activity_change_observation_number_t::OBSERVATION_32:
+        // Do nothing
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_64:
+        val |= 0x01;
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_128:
+        val |= 0x02;
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_256:
+        val |= 0x03;
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_512:
+        val |= 0x04;
+        break;
+    }
+
+    if (data_source == interrupt_data_source_t::ACC_FILT_2)
+        val |= 0x10;
+
+    if (enableX)
+        val |= 0x20;
+
+    if (enableY)
+        val |= 0x40;
+
+    if (enableZ)
+        val |= 0x80;
+
+    write(BMA400_REG_ACT_CHNG_INT_CONFIG_1, val);
+}
+
+/*!
+ *  @brief  Configures Activity change Interrupt
+ *  @param  threshold threshold - in mg
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  enable true if enables interrupt otherwise it disables the interrupt
+ *  @param  observation_number number of observations generates the interrupt
+ *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ */
+void BMA400::ConfigureActivityChangeInterrupt(bool enable,
+                                              interrupt_pin_t pin,
+                                              float threshold,
+                                              activity_change_observation_number_t observation_number,
+                                              interrupt_data_source_t data_source,
+                                              bool enableX, bool enableY, bool enableZ)
+{
+    if (!enable) //# Just disable the interrupt
+    {
+        unset(BMA400_REG_INT_CONFIG_1, 4);
+        return;
+    }
+
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt_source_t::ADV_ACTIVITY_CHANGE, pin);
+
+    set(BMA400_REG_INT_CONFIG_1, 4);
+    threshold /= 8.0;
+    threshold = round(threshold);
+    write(BMA400_REG_ACT_CHNG_INT_CONFIG_0, (uint8_t)threshold);
+
+    uint8_t val = 0;
+
+    switch (observation_number)
+    {
+    case activity_change_observation_number_t::OBSERVATION_32:
+        // Do nothing
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_64:
+        val |= 0x01;
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_128:
+        val |= 0x02;
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_256:
+        val |= 0x03;
+        break;
+
+    case activity_change_observation_number_t::OBSERVATION_512:
+        val |= 0x04;
+        break;
+    }
+
+    if (data_source == interrupt_data_source_t::ACC_FILT_2)
+        val |= 0x10;
+
+    if (enableX)
+        val |= 0x20;
+
+    if (enableY)
+        val |= 0x40;
+
+    if (enableZ)
+        val |= 0x80;
+
+    write(BMA400_REG_ACT_CHNG_INT_CONFIG_1, val);
+}
+
+/*!
+ *  @brief  Configures Single and double tap interrupts
+ *  @param  enableSingleTap true enables single tap interrupt otherwise it disables the interrupt
+ *  @param  enableDoubleTap true enables double tap interrupt otherwise it disables the interrupt
+ *  @param  axis tap axis can be either X, Y, or Z. use tap_axis_t data def
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  mode Interrupt mode. On Activity or On Inactivity
+ *  @param  sensitivity sensitivity level to tap ranged from 7 (highest) to 0 (lowest). use tap_sensitivity_level_t type def 
+ *  @param  pick_to_pick_interval maximum time between upper and lower peak of valid taps (in data samples). use tap_max_pick_to_pick_interval_t data type
+ *  @param  quiet_interval Minimum quiet time (no tap) between two consecutive taps (in data samples). use tap_min_quiet_between_taps_t data type
+ *  @param  double_taps_time Mininum time between two taps in a double tap (in data samples). use tap_min_quiet_inside_double_taps_t data type
+ */
+void BMA400::ConfigureTapInterrupt(
+    bool enableSingleTap, bool enableDoubleTap,
+    tap_axis_t axis,
+    interrupt_pin_t pin,
+    tap_sensitivity_level_t sensitivity,
+    tap_max_pick_to_pick_interval_t pick_to_pick_interval,
+    tap_min_quiet_between_taps_t quiet_interval,
+    tap_min_quiet_inside_double_taps_t double_taps_time)
+{
+
+    if (!enableSingleTap & !enableDoubleTap)
+    {
+        unset(BMA400_REG_INT_CONFIG_1, 2);
+        unset(BMA400_REG_INT_CONFIG_1, 3);
+        return; //# Just disable both interrupts
+    }
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT12_MAP, 0);
-            set(BMA400_REG_INT12_MAP, 4);
-            break;
-        }
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt_source_t::ADV_SINGLE_TAP, pin);
+
+    //# Force increasing the ODR to 200Hz
+    output_data_rate_t rate = GetRateDescriptor().rate;
+    if ((rate == output_data_rate_t::Filter1_024x_12Hz) |
+        (rate == output_data_rate_t::Filter1_024x_25Hz) |
+        (rate == output_data_rate_t::Filter1_024x_50Hz) |
+        (rate == output_data_rate_t::Filter1_024x_100Hz))
+        SetDataRate(output_data_rate_t::Filter1_024x_200Hz);
+    else if ((rate == output_data_rate_t::Filter1_048x_12Hz) |
+             (rate == output_data_rate_t::Filter1_048x_25Hz) |
+             (rate == output_data_rate_t::Filter1_048x_50Hz) |
+             (rate == output_data_rate_t::Filter1_048x_100Hz) |
+             (rate == output_data_rate_t::Filter2_100Hz) |
+             (rate == output_data_rate_t::Filter2_100Hz_LPF_1Hz))
+        SetDataRate(output_data_rate_t::Filter1_048x_200Hz);
+
+    //# Enabling the interrupts
+    if (enableSingleTap)
+        set(BMA400_REG_INT_CONFIG_1, 2);
+    else
+        unset(BMA400_REG_INT_CONFIG_1, 2);
+
+    if (enableDoubleTap)
+        set(BMA400_REG_INT_CONFIG_1, 3);
+    else
+        unset(BMA400_REG_INT_CONFIG_1, 3);
+
+    uint8_t config[2];
+    encodeTapInterrupt(axis, sensitivity, pick_to_pick_interval, quiet_interval, double_taps_time, config);
+    write(BMA400_REG_TAP_CONFIG_0, 2, config);
+}
+
+/*!
+ *  @brief  Configures Orientation Changed Interrupt
+ *  @param  enable  set true to enable the interrupt
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
+ *  @param  source  data source is used as input for the orientation change detection. 
+ * see orientation_reference_update_data_source_t for mode details
+ *  @param  reference_update_mode   mode of updating the orientation refernce vector (acceleration). 
+ * see orientation_reference_update_data_source_t for more details
+ *  @param  threshold   Threshold of orientation change will generate interrupt (raw value) - 1 LSB = 8 mg
+ *  @param  duration    Minimum duration of the new orientation will generate interrupt (raw value) - 1 LSB = 10ms
+ */
+void BMA400::ConfigureOrientationChangeInterrupt(
+    bool enable,
+    bool enableX, bool enableY, bool enableZ,
+    interrupt_pin_t pin,
+    orientation_change_data_source_t source,
+    orientation_reference_update_data_source_t reference_update_mode,
+    uint8_t threshold,
+    uint8_t duration)
+{
+    if (!enable) //# Just disable the interrupt
+    {
+        unset(BMA400_REG_INT_CONFIG_0, 1);
+        return;
+    }
+
+    //# enable the interrupt
+    set(BMA400_REG_INT_CONFIG_0, 1);
+
+    //# Wiring Interrupt to Interrupt pins
+    LinkToInterruptPin(interrupt_source_t::ADV_ORIENTATION_CHANGE, pin);
+
+    uint8_t val;
+    switch (reference_update_mode)
+    {
+    case orientation_reference_update_data_source_t::ORIENT_UPDATE_MANUAL:
+        val = 0x00;
         break;
 
-    case interrupt_source_t::ADV_SINGLE_TAP:
-    case interrupt_source_t::ADV_DOUBLE_TAP:
-        switch (pin)
-        {
+    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ:
+        val = 0x04;
+        break;
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT12_MAP, 2);
-            unset(BMA400_REG_INT12_MAP, 6);
-            break;
+    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ_LP_1HZ:
+        val = 0x08;
+        break;
+    }
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT12_MAP, 2);
-            unset(BMA400_REG_INT12_MAP, 6);
-            break;
+    if (source == orientation_change_data_source_t::ORIENT_UPDATE_ACC_FILT_2_100HZ_LP_1HZ)
+        val |= 0x10;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT12_MAP, 2);
-            set(BMA400_REG_INT12_MAP, 6);
-            break;
+    if (enableX)
+        val |= 0x20;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT12_MAP, 2);
-            set(BMA400_REG_INT12_MAP, 6);
-            break;
-        }
+    if (enableY)
+        val |= 0x40;
+
+    if (enableZ)
+        val |= 0x80;
+
+    write(BMA400_REG_ORIENT_CONFIG_0, val);
+    write(BMA400_REG_ORIENT_CONFIG_1, threshold);
+    write(BMA400_REG_ORIENT_CONFIG_3, duration);
+}
+
+/*!
+ *  @brief  Configures Orientation Changed Interrupt
+ *  @param  enable  set true to enable the interrupt
+ *  @param  enableX enables interrupt on X Axis
+ *  @param  enableY enables interrupt on Y Axis
+ *  @param  enableZ enables interrupt on Z Axis
+ *  @param  source  data source is used as input for the orientation change detection. 
+ * see orientation_reference_update_data_source_t for mode details
+ *  @param  reference_update_mode   mode of updating the orientation refernce vector (acceleration). 
+ * see orientation_reference_update_data_source_t for more details
+ *  @param  threshold   Threshold of orientation change will generate interrupt (in mg scale)
+ *  @param  duration    Minimum duration of the new orientation will generate interrupt (in ms scale)
+ */
+void BMA400::ConfigureOrientationChangeInterrupt(
+    bool enable,
+    bool enableX, bool enableY, bool enableZ,
+    interrupt_pin_t pin,
+    orientation_change_data_source_t source,
+    orientation_reference_update_data_source_t reference_update_mode,
+    float threshold,
+    float duration)
+{
+    if (!enable) //# Just disable the interrupt
+    {
+        unset(BMA400_REG_INT_CONFIG_0, 1);
+        return;
+    }
+
+    //# enable the interrupt
+    set(BMA400_REG_INT_CONFIG_0, 1);
+
+    uint8_t val;
+    switch (reference_update_mode)
+    {
+    case orientation_reference_update_data_source_t::ORIENT_UPDATE_MANUAL:
+        val = 0x00;
         break;
 
-    case interrupt_source_t::ADV_ACTIVITY_CHANGE:
-        switch (pin)
-        {
+    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ:
+        val = 0x04;
+        break;
 
-        case interrupt_pin_t::INT_NONE:
-            unset(BMA400_REG_INT12_MAP, 3);
-            unset(BMA400_REG_INT12_MAP, 7);
-            break;
+    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ_LP_1HZ:
+        val = 0x08;
+        break;
+    }
 
-        case interrupt_pin_t::INT_PIN_1:
-            set(BMA400_REG_INT12_MAP, 3);
-            unset(BMA400_REG_INT12_MAP, 7);
-            break;
+    if (source == orientation_change_data_source_t::ORIENT_UPDATE_ACC_FILT_2_100HZ_LP_1HZ)
+        val |= 0x10;
 
-        case interrupt_pin_t::INT_PIN_2:
-            unset(BMA400_REG_INT12_MAP, 3);
-            set(BMA400_REG_INT12_MAP, 7);
-            break;
+    if (enableX)
+        val |= 0x20;
 
-        case interrupt_pin_t::INT_PIN_BOTH:
-            set(BMA400_REG_INT12_MAP, 3);
-            set(BMA400_REG_INT12_MAP, 7);
-            break;
+    if (enableY)
+        val |= 0x40;
+
+    if (enableZ)
+        val |= 0x80;
+
+    write(BMA400_REG_ORIENT_CONFIG_0, val);
+
+    threshold /= 8;
+    val = threshold > 255 ? 255 : (uint8_t)threshold;
+    write(BMA400_REG_ORIENT_CONFIG_1, val);
+
+    duration /= 10;
+    val = duration > 255 ? 255 : (uint8_t)duration;
+    write(BMA400_REG_ORIENT_CONFIG_3, val);
+}
+
+/*!
+ *  @brief  Sets reference vector(acceleration) for Orientation Changed Interrupt
+ *  @param  values  Address of arrary 8bit values (length >= 6) includes the values as follows
+ * X(LSB) X(MSB) Y(LSB) Y(MSB) Z(LSB) Z(MSB) 
+ */
+void BMA400::SetOrientationReference(uint8_t *values)
+{
+    write(BMA400_REG_ORIENT_CONFIG_4, 6, values);
+}
+
+/*!
+ *  @brief  Automatically Use current values to set reference vector(acceleration) for Orientation Changed Interrupt
+ */
+void BMA400::SetOrientationReference()
+{
+    uint8_t data[6] = {0};
+    read(BMA400_REG_ACC_DATA, 6, data);
+    write(BMA400_REG_ORIENT_CONFIG_4, 6, data);
+}
+
+/*!
+ *  @brief  Getting the reference vector of the Orientation Changed Interrupt (set manually or updated by the sensor)
+ *  @param  values Address of arrary 16bit values (length >= 3) receives raw X Y Z
+ *  @return true if the reference was read
+ */
+bool BMA400::GetOrientationReference(int16_t *values)
+{
+    uint8_t data[6] = {0};
+    if (read(BMA400_REG_ORIENT_CONFIG_4, 6, data) != bus_status_t::BUS_OK)
+        return false;
+    decodeAcceleration(data, values);
+    return true;
+}
+
+//* Private methods
+BMA400::bus_status_t BMA400::read(uint8_t _register, uint16_t length, uint8_t *values)
+{
+    uint16_t chunk = GetMaxTransferSize();
+    uint32_t start = micros();
+
+    while (length > 0)
+    {
+        uint16_t size = length > chunk ? chunk : length;
+        bus_status_t status = transfer(_register, size, values, false, start);
+        if (status != bus_status_t::BUS_OK)
+        {
+            memset(values + size, 0xFF, length - size); //# the bus is down, not trying the remaining chunks
+            return status;
         }
-        break;
+        values += size;
+        length -= size;
+
+        //# FIFO data is streamed from the same register, the rest continues at the next address
+        if (_register != BMA400_REG_FIFO_DATA)
+            _register += size;
+    }
+
+    return bus_status_t::BUS_OK;
+}
+
+uint8_t BMA400::read(uint8_t _register)
+{
+    uint8_t value = 0xFF;
+    transfer(_register, 1, &value, false, micros());
+    return value;
+}
+
+void BMA400::write(uint8_t _register, const uint8_t &value)
+{
+    transfer(_register, 1, (uint8_t *)&value, true, micros());
+}
 
-    default:
-        break;
-    }
+void BMA400::write(uint8_t _register, const uint8_t &value, const uint8_t &mask)
+{
+    BeginTransaction(); //# no other task may write the register between read and write
+    uint8_t val = (read(_register) & mask) | value;
+    write(_register, val);
+    EndTransaction();
 }
 
-/*!
- *  @brief  Configures Generic Interrupt 1 or 2
- *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
- *  @param  enable true if enables interrupt otherwise it disables the interrupt
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  reference mode of updating reference acceleration. see generic_interrupt_reference_update_t
- *  @param  mode Interrupt mode. On Activity or On Inactivity
- *  @param  threshold threshold (raw value) LSB = 8mg
- *  @param  duration minimum duration can generate interrupt - (raw value) depending on ODR
- *  @param  hystersis hystersis amplitude. can be selected between 0, 24, 48, 96mg
- *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
- *  @param  enableX enables interrupt on X Axis
- *  @param  enableY enables interrupt on Y Axis
- *  @param  enableZ enables interrupt on Z Axis
- *  @param  all_combined if true uses AND logic applies on all axes to generate interrupts, otherwise OR logic
- *  @param  ignoreSamplingRateFix if false automatically increases the ODR to 100Hz if it's lower
- */
-void BMA400::ConfigureGenericInterrupt(
-    interrupt_source_t interrupt, bool enable,
-    interrupt_pin_t pin,
-    generic_interrupt_reference_update_t reference,
-    generic_interrupt_mode_t mode,
-    uint8_t threshold,
-    uint16_t duration,
-    generic_interrupt_hysteresis_amplitude_t hystersis,
-    interrupt_data_source_t data_source,
-    bool enableX, bool enableY, bool enableZ,
-    bool all_combined, bool ignoreSamplingRateFix)
+BMA400::bus_status_t BMA400::write(uint8_t _register, uint16_t length, const uint8_t *values)
 {
-    if ((interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_1) &
-        (interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_2)) //# ignore if not a generic interrupt
-        return;
-    if (!enable) //# just disable the interrupt
+    uint16_t chunk = GetMaxTransferSize() - 1; //# one byte is taken by the register address
+    uint32_t start = micros();
+
+    while (length > 0)
     {
-        unset(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
-        return;
+        uint16_t size = length > chunk ? chunk : length;
+        bus_status_t status = transfer(_register, size, (uint8_t *)values, true, start);
+        if (status != bus_status_t::BUS_OK)
+            return status; //# not writing the rest after a failed chunk
+        values += size;
+        length -= size;
+        _register += size;
     }
 
-    //# Wiring Interrupt to Interrupt pins
-    LinkToInterruptPin(interrupt, pin);
+    return bus_status_t::BUS_OK;
+}
 
-    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
-    uint8_t val = 0;
+BMA400::bus_status_t BMA400::transfer(uint8_t _register, uint16_t length, uint8_t *values, bool isWrite, uint32_t start)
+{
+    if (lock == nullptr)
+        return retry(_register, length, values, isWrite, start);
 
-    //# increasing the rate to be at least 100Hz
-    if (!ignoreSamplingRateFix)
+    lock->Lock();
+    bus_status_t status = retry(_register, length, values, isWrite, start);
+    lock->Unlock();
+    return status;
+}
+
+BMA400::bus_status_t BMA400::retry(uint8_t _register, uint16_t length, uint8_t *values, bool isWrite, uint32_t start)
+{
+    bus_status_t status;
+    uint8_t attempt = 0;
+
+    if (polling) //# resuming the attempts of the transaction retried by Poll
     {
-        output_data_rate_t rate = GetDataRate();
-        if ((rate == output_data_rate_t::Filter1_024x_12Hz) |
-            (rate == output_data_rate_t::Filter1_024x_25Hz) |
-            (rate == output_data_rate_t::Filter1_024x_50Hz))
-            SetDataRate(output_data_rate_t::Filter1_024x_100Hz);
-        else if ((rate == output_data_rate_t::Filter1_048x_12Hz) |
-                 (rate == output_data_rate_t::Filter1_048x_25Hz) |
-                 (rate == output_data_rate_t::Filter1_048x_50Hz))
-            SetDataRate(output_data_rate_t::Filter1_048x_100Hz);
+        if (poll_attempt == 0)
+            poll_start = start;
+        attempt = poll_attempt;
+        start = poll_start;
+        poll_attempt = 0;
     }
 
-    //# enabling interrupt
-    set(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
-
-    //# setting config 0 register
-    switch (hystersis)
+    for (;; attempt++)
     {
-    case generic_interrupt_hysteresis_amplitude_t::AMP_0mg:
-        // Do nothing
-        break;
+        bus_counters.transactions++;
+        bus_counters.bytes += length;
+        status = isWrite ? writeOnce(_register, values, length) : readOnce(_register, length, values);
+        if (status == bus_status_t::BUS_OK)
+            return status;
 
-    case generic_interrupt_hysteresis_amplitude_t::AMP_24mg:
-        val |= 0x01;
-        break;
+        bus_counters.errors++;
+        if (mux != nullptr)
+            mux->Invalidate(); //# the mux state is unknown after a failed transaction
 
-    case generic_interrupt_hysteresis_amplitude_t::AMP_48mg:
-        val |= 0x02;
-        break;
+        if (attempt >= bus_retries || status == bus_status_t::BUS_DATA_TOO_LONG)
+            break;
 
-    case generic_interrupt_hysteresis_amplitude_t::AMP_96mg:
-        val |= 0x03;
-        break;
-    }
+        //# a partial read already cleared the status / popped the FIFO, a retry would return other data
+        if (!isWrite && status == bus_status_t::BUS_SHORT_READ && isClearedOnRead(_register, length))
+            break;
 
-    switch (reference)
-    {
-    case generic_interrupt_reference_update_t::MANUAL_UPDATE:
-        // Do nothing
-        break;
+        if (bus_timeout > 0 && micros() - start >= bus_timeout)
+        {
+            status = bus_status_t::BUS_TIMEOUT;
+            bus_counters.timeouts++;
+            break;
+        }
 
-    case generic_interrupt_reference_update_t::ONETIME_UPDATE:
-        val |= 0x04;
-        break;
+        bus_counters.retries++;
+        if (bus_recovery_handler != nullptr)
+        {
+            bus_counters.recoveries++;
+            bus_recovery_handler();
+        }
 
-    case generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILTx:
-        val |= 0x08;
-        break;
+        if (polling) //# Poll never waits, its next call retries once the backoff elapsed
+        {
+            poll_attempt = attempt + 1;
+            poll_resume = micros() + getBackoff(attempt);
+            return status;
+        }
 
-    case generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILT_LP:
-        val |= 0x0C;
-        break;
+        uint32_t backoff = getBackoff(attempt);
+        if (backoff >= 1000)
+            delay(backoff / 1000);
+        if (backoff % 1000 > 0)
+            delayMicroseconds(backoff % 1000);
     }
 
-    if (data_source == interrupt_data_source_t::ACC_FILT_2)
-        val |= 0x10;
+    bus_counters.failures++;
+    last_bus_status = status;
+    if (!isWrite)
+        memset(values, 0xFF, length); //# same as a failed Wire read
+    return status;
+}
 
-    if (enableX)
-        val |= 0x20;
+uint32_t BMA400::getBackoff(uint8_t attempt)
+{
+    //# doubling stops at 2^15, so the delay stays below 2^31 us (wrap-safe micros() compare) whatever the retry count
+    return (uint32_t)bus_backoff << (attempt < 15 ? attempt : 15);
+}
 
-    if (enableY)
-        val |= 0x40;
+BMA400::bus_status_t BMA400::readOnce(uint8_t _register, uint16_t length, uint8_t *values)
+{
+    if (!selectChannel())
+        return bus_status_t::BUS_ERROR;
 
-    if (enableZ)
-        val |= 0x80;
+    if (bus != nullptr)
+        return bus->ReadRegisters(address, _register, values, length) ? bus_status_t::BUS_OK : bus_status_t::BUS_ERROR;
 
-    write(_register, val);
+#if defined(ARDUINO)
+    if (wire == nullptr)
+        return bus_status_t::BUS_NOT_INITIALIZED;
 
-    //# setting config 1 register
-    _register++;
-    val = 0;
+    wire->beginTransmission(address);
+    wire->write(_register);
+    bus_status_t status = toBusStatus(wire->endTransmission());
+    if (status != bus_status_t::BUS_OK)
+        return status;
 
-    if (all_combined)
-        val |= 0x01;
+    uint8_t received = wire->requestFrom(address, (uint8_t)length);
+    for (uint16_t i = 0; i < length; i++)
+        values[i] = wire->read();
 
-    if (mode == generic_interrupt_mode_t::ACTIVITY_DETECTION)
-        val |= 0x02;
+    return received < length ? bus_status_t::BUS_SHORT_READ : bus_status_t::BUS_OK;
+#else
+    return bus_status_t::BUS_NOT_INITIALIZED;
+#endif
+}
 
-    write(_register, val);
+BMA400::bus_status_t BMA400::writeOnce(uint8_t _register, const uint8_t *values, uint16_t length)
+{
+    if (!selectChannel())
+        return bus_status_t::BUS_ERROR;
 
-    //# setting config 2 register
-    _register++;
-    write(_register, threshold);
+    if (bus != nullptr)
+        return bus->WriteRegisters(address, _register, values, length) ? bus_status_t::BUS_OK : bus_status_t::BUS_ERROR;
 
-    //# setting config 3 register
-    _register++;
-    write(_register, (uint8_t)(duration >> 8));
+#if defined(ARDUINO)
+    if (wire == nullptr)
+        return bus_status_t::BUS_NOT_INITIALIZED;
 
-    //# setting config 4 register
-    _register++;
-    write(_register, (uint8_t)duration);
+    wire->beginTransmission(address);
+    wire->write((uint8_t)_register);
+    for (uint16_t i = 0; i < length; i++)
+        wire->write(values[i]);
+    return toBusStatus(wire->endTransmission());
+#else
+    return bus_status_t::BUS_NOT_INITIALIZED;
+#endif
 }
 
-/*!
- *  @brief  Configures Generic Interrupt 1 or 2
- *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
- *  @param  enable true if enables interrupt otherwise it disables the interrupt
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  reference mode of updating reference acceleration. see generic_interrupt_reference_update_t
- *  @param  mode Interrupt mode. On Activity or On Inactivity
- *  @param  threshold threshold - in mg
- *  @param  duration minimum duration can generate interrupt - in mili seconds
- *  @param  hystersis hystersis amplitude. can be selected between 0, 24, 48, 96mg
- *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
- *  @param  enableX enables interrupt on X Axis
- *  @param  enableY enables interrupt on Y Axis
- *  @param  enableZ enables interrupt on Z Axis
- *  @param  all_combined if true uses AND logic applies on all axes to generate interrupts, otherwise OR logic
- *  @param  ignoreSamplingRateFix if false automatically increases the ODR to 100Hz if it's lower
- */
-void BMA400::ConfigureGenericInterrupt(
-    interrupt_source_t interrupt, bool enable,
-    interrupt_pin_t pin,
-    generic_interrupt_reference_update_t reference,
-    generic_interrupt_mode_t mode,
-    float threshold,
-    float duration,
-    generic_interrupt_hysteresis_amplitude_t hystersis,
-    interrupt_data_source_t data_source,
-    bool enableX, bool enableY, bool enableZ,
-    bool all_combined, bool ignoreSamplingRateFix)
+bool BMA400::isClearedOnRead(uint8_t _register, uint16_t length)
 {
-    if ((interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_1) &
-        (interrupt != interrupt_source_t::ADV_GENERIC_INTERRUPT_2)) //# ignore if not a generic interrupt
-        return;
-    if (!enable) //# just disable the interrupt
+    //# EVENT and INT_STAT0..2 are cleared on read, FIFO_DATA pops the FIFO
+    uint16_t last = _register + length - 1;
+    return (_register <= BMA400_REG_INT_STAT_2 && last >= BMA400_REG_EVENT) ||
+           (_register <= BMA400_REG_FIFO_DATA && last >= BMA400_REG_FIFO_DATA);
+}
+
+BMA400::bus_status_t BMA400::toBusStatus(uint8_t code)
+{
+    switch (code) //# endTransmission() return codes
     {
-        unset(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
-        return;
+    case 0:
+        return bus_status_t::BUS_OK;
+    case 1:
+        return bus_status_t::BUS_DATA_TOO_LONG;
+    case 2:
+        return bus_status_t::BUS_NACK_ADDRESS;
+    case 3:
+        return bus_status_t::BUS_NACK_DATA;
+    case 5:
+        return bus_status_t::BUS_TIMEOUT;
+    default:
+        return bus_status_t::BUS_ERROR;
     }
+}
 
-    //# Wiring Interrupt to Interrupt pins
-    LinkToInterruptPin(interrupt, pin);
-
-    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
-    uint8_t val = 0;
+uint16_t BMA400::decodeFifo(const uint8_t *data, uint16_t length, int16_t *values, uint16_t max_samples,
+                            uint32_t *sensor_time, uint16_t &consumed, bool &end)
+{
+    uint16_t count = 0;
+    uint16_t index = 0;
 
-    //# increasing the rate to be at least 100Hz
-    if (!ignoreSamplingRateFix)
+    while (index < length && count < max_samples)
     {
-        output_data_rate_t rate = GetDataRate();
-        if ((rate == output_data_rate_t::Filter1_024x_12Hz) |
-            (rate == output_data_rate_t::Filter1_024x_25Hz) |
-            (rate == output_data_rate_t::Filter1_024x_50Hz))
-            SetDataRate(output_data_rate_t::Filter1_024x_100Hz);
-        else if ((rate == output_data_rate_t::Filter1_048x_12Hz) |
-                 (rate == output_data_rate_t::Filter1_048x_25Hz) |
-                 (rate == output_data_rate_t::Filter1_048x_50Hz))
-            SetDataRate(output_data_rate_t::Filter1_048x_100Hz);
+        uint8_t header = data[index];
+
+        if (header == 0x80) //# empty frame, nothing more to read
+        {
+            end = true;
+            index = length;
+            break;
+        }
+        else if ((header & 0xE1) == 0x80 && (header & 0x0E)) //# data frame
+        {
+            bool is8bit = (header & 0x10) == 0x10;
+            uint8_t size = 1;
+            for (uint8_t axis = 0; axis < 3; axis++)
+                if (header & (0x02 << axis))
+                    size += is8bit ? 1 : 2;
+
+            if (index + size > length)
+                break;
+
+            uint16_t offset = index + 1;
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                int16_t value = 0;
+                if (header & (0x02 << axis))
+                {
+                    if (is8bit)
+                        value = (int8_t)data[offset++] * 16;
+                    else
+                    {
+                        value = data[offset] + 256 * (data[offset + 1] & 0x0F);
+                        if (value > 2047)
+                            value -= 4096;
+                        offset += 2;
+                    }
+                }
+                values[count * 3 + axis] = value;
+            }
+            count++;
+            index += size;
+        }
+        else if (header == 0xA0) //# sensor time frame
+        {
+            if (index + 4 > length)
+                break;
+            if (sensor_time != nullptr)
+                *sensor_time = data[index + 1] + data[index + 2] * 256 + (uint32_t)data[index + 3] * 256 * 256;
+            index += 4;
+        }
+        else if (header == 0x48) //# control frame (configuration changed)
+        {
+            if (index + 2 > length)
+                break;
+            index += 2;
+        }
+        else //# unknown frame, dropping the rest
+        {
+            end = true;
+            index = length;
+            break;
+        }
     }
 
-    //# enabling interrupt
-    set(BMA400_REG_INT_CONFIG_0, interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? 2 : 3);
+    consumed = index;
+    return count;
+}
 
-    //# setting config 0 register
-    switch (hystersis)
-    {
-    case generic_interrupt_hysteresis_amplitude_t::AMP_0mg:
-        // Do nothing
-        break;
+void BMA400::setRateDescriptor(output_data_rate_t rate, acceleation_range_t range)
+{
+    rate_descriptor.rate = rate;
+    rate_descriptor.range = range;
+    rate_descriptor.frequency = BMA400_RATES[rate].frequency;
+    rate_descriptor.period = 1000 / rate_descriptor.frequency;
+    rate_descriptor.bandwidth = BMA400_RATES[rate].bandwidth;
+    rate_descriptor.lsb_per_g = range == acceleation_range_t::UNKNOWN_RANGE ? 1024 : 1024 >> (range - acceleation_range_t::RANGE_2G);
+    rate_descriptor_valid = true;
+}
 
-    case generic_interrupt_hysteresis_amplitude_t::AMP_24mg:
-        val |= 0x01;
-        break;
+void BMA400::invalidateRateDescriptor(uint8_t _register, uint16_t length)
+{
+    if (_register <= BMA400_REG_ACC_CONFIG_2 && _register + length > BMA400_REG_ACC_CONFIG_0)
+        rate_descriptor_valid = false;
 
-    case generic_interrupt_hysteresis_amplitude_t::AMP_48mg:
-        val |= 0x02;
-        break;
+    //# a command may be a soft reset, which restores the default data rate and range
+    if (_register <= BMA400_REG_COMMAND && _register + length > BMA400_REG_COMMAND)
+        rate_descriptor_valid = false;
+}
 
-    case generic_interrupt_hysteresis_amplitude_t::AMP_96mg:
-        val |= 0x03;
-        break;
+void BMA400::decodeAcceleration(const uint8_t *data, int16_t *values)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        values[i] = data[0 + i * 2] + 256 * data[1 + i * 2];
+        if (values[i] > 2047)
+            values[i] -= 4096;
     }
+}
 
-    switch (reference)
-    {
-    case generic_interrupt_reference_update_t::MANUAL_UPDATE:
-        // Do nothing
-        break;
+void BMA400::decodeStepStatus(const uint8_t *data, step_status_t &status)
+{
+    status.steps = data[0] + data[1] * 256 + (uint32_t)data[2] * 256 * 256;
+    status.activity = (activity_t)(data[3] & 0x03);
+    if (status.activity > activity_t::ACTIVITY_RUNNING) //# reserved value
+        status.activity = activity_t::ACTIVITY_STILL;
+}
 
-    case generic_interrupt_reference_update_t::ONETIME_UPDATE:
-        val |= 0x04;
-        break;
+bool BMA400::reportActivity(const step_status_t &status)
+{
+    if (status.activity == activity)
+        return false;
 
-    case generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILTx:
-        val |= 0x08;
-        break;
+    activity_t previous = activity;
+    activity = status.activity;
+    if (activity_callback != nullptr)
+        activity_callback(previous, activity, status.steps, activity_context);
+    return true;
+}
 
-    case generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILT_LP:
-        val |= 0x0C;
-        break;
+#if defined(BMA400_TELEMETRY)
+void BMA400::recordInterrupts(interrupt_source_t interrupts)
+{
+    uint32_t time;
+    uint32_t count = getEdgeCount(&time);
+
+    //# odd sequence: readers (GetTelemetry) discard the copy
+    telemetry_sequence = telemetry_sequence + 1;
+    __sync_synchronize();
+
+    telemetry.reads++;
+    if (interrupts == interrupt_source_t::ALL_INTERRUPTS)
+        telemetry.empty++;
+    for (uint8_t i = 0; i < 16; i++)
+        if ((interrupts & (1 << i)) != 0)
+            telemetry.sources[i]++;
+
+    //# latency only for reads served after a new edge
+    if (count != edge_served)
+    {
+        edge_served = count;
+        uint32_t latency = micros() - time;
+        uint32_t limit = BMA400_TELEMETRY_RESOLUTION;
+        uint8_t bucket = 0;
+        while (bucket < BMA400_TELEMETRY_BUCKETS - 1 && latency >= limit)
+        {
+            limit <<= 1;
+            bucket++;
+        }
+        telemetry.latency[bucket]++;
+        if (latency > telemetry.max_latency)
+            telemetry.max_latency = latency;
     }
 
-    if (data_source == interrupt_data_source_t::ACC_FILT_2)
-        val |= 0x10;
+    __sync_synchronize();
+    telemetry_sequence = telemetry_sequence + 1;
+}
 
-    if (enableX)
-        val |= 0x20;
+uint32_t BMA400::getEdgeCount(uint32_t *time)
+{
+    //# re-reading until no edge came in between (multi-byte reads are not atomic on 8 bit MCUs)
+    uint32_t count, last;
+    do
+    {
+        count = edge_count;
+        last = edge_time;
+    } while (count != edge_count);
 
-    if (enableY)
-        val |= 0x40;
+    if (time != nullptr)
+        *time = last;
+    return count;
+}
+#endif
 
-    if (enableZ)
-        val |= 0x80;
+BMA400::interrupt_source_t BMA400::decodeInterrupts(const uint8_t *interrupts)
+{
+    uint16_t result = 0;
 
-    write(_register, val);
+    if (interrupts[0] & 0x01)
+        result |= interrupt_source_t::BAS_WAKEUP;
 
-    //# setting config 1 register
-    _register++;
-    val = 0;
+    if (interrupts[0] & 0x02)
+        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE;
 
-    if (all_combined)
-        val |= 0x01;
+    if (interrupts[0] & 0x04)
+        result |= interrupt_source_t::ADV_GENERIC_INTERRUPT_1;
 
-    if (mode == generic_interrupt_mode_t::ACTIVITY_DETECTION)
-        val |= 0x02;
+    if (interrupts[0] & 0x08)
+        result |= interrupt_source_t::ADV_GENERIC_INTERRUPT_2;
 
-    write(_register, val);
+    if ((interrupts[0] & 0x10) | (interrupts[1] & 0x10) | (interrupts[2] & 0x10))
+        result |= interrupt_source_t::BAS_ENGINE_OVERRUN;
 
-    //# setting config 2 register
-    _register++;
-    threshold /= 8;
-    val = threshold > 255 ? 255 : (uint8_t)threshold;
-    write(_register, val);
+    if (interrupts[0] & 0x20)
+        result |= interrupt_source_t::BAS_FIFO_FULL;
 
-    //# setting config 3 register
-    _register++;
+    if (interrupts[0] & 0x40)
+        result |= interrupt_source_t::BAS_FIFO_WATERMARK;
 
-    switch (GetDataRate())
-    {
-    case output_data_rate_t::Filter1_024x_12Hz:
-    case output_data_rate_t::Filter1_048x_12Hz:
-        duration *= 0.0125;
-        break;
+    if (interrupts[0] & 0x80)
+        result |= interrupt_source_t::BAS_DATA_READY;
 
-    case output_data_rate_t::Filter1_024x_25Hz:
-    case output_data_rate_t::Filter1_048x_25Hz:
-        duration *= 0.025;
-        break;
+    if (interrupts[1] & 0x01)
+        result |= interrupt_source_t::ADV_STEP_DETECTOR_COUNTER;
 
-    case output_data_rate_t::Filter1_024x_50Hz:
-    case output_data_rate_t::Filter1_048x_50Hz:
-        duration *= 0.05;
-        break;
+    if (interrupts[1] & 0x02)
+        result |= interrupt_source_t::ADV_STEP_DETECTOR_COUNTER_DOUBLE_STEP;
 
-    case output_data_rate_t::Filter1_024x_100Hz:
-    case output_data_rate_t::Filter1_048x_100Hz:
-    case output_data_rate_t::Filter2_100Hz:
-    case output_data_rate_t::Filter2_100Hz_LPF_1Hz:
-        duration *= 0.1;
-        break;
+    if (interrupts[1] & 0x04)
+        result |= interrupt_source_t::ADV_SINGLE_TAP;
 
-    case output_data_rate_t::Filter1_024x_200Hz:
-    case output_data_rate_t::Filter1_048x_200Hz:
-        duration *= 0.2;
-        break;
+    if (interrupts[1] & 0x08)
+        result |= interrupt_source_t::ADV_DOUBLE_TAP;
 
-    case output_data_rate_t::Filter1_024x_400Hz:
-    case output_data_rate_t::Filter1_048x_400Hz:
-        duration *= 0.4;
-        break;
+    //# INT_STAT2 holds the activity change flags per axis. the per axis flags are kept for compatibility
+    if (interrupts[2] & 0x07)
+        result |= interrupt_source_t::ADV_ACTIVITY_CHANGE;
 
-    case output_data_rate_t::Filter1_024x_800Hz:
-    case output_data_rate_t::Filter1_048x_800Hz:
-        duration *= 0.8;
-        break;
+    if (interrupts[2] & 0x01)
+        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE_X;
 
-    default:
-        break;
-    }
-    uint16_t dur = (uint16_t)round(duration);
+    if (interrupts[2] & 0x02)
+        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE_Y;
 
-    write(_register, (uint8_t)(dur >> 8));
+    if (interrupts[2] & 0x04)
+        result |= interrupt_source_t::ADV_ORIENTATION_CHANGE_Z;
 
-    //# setting config 4 register
-    _register++;
-    write(_register, (uint8_t)dur);
+    return (interrupt_source_t)result;
 }
 
-/*!
- *  @brief  Manually updating the reference acceleration
- *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
- *  @param  values raw values in order of [0]X(MSB) [1]X(LSB) [2]Y(MSB) [2]Y(LSB) [3]Z(MSB) [3]Z(LSB) 
- */
-void BMA400::SetGenericInterruptReference(interrupt_source_t interrupt, uint8_t *values)
+bool BMA400::startFifoDrain(sample_block_t &block, fifo_drain_t &drain, uint16_t length)
 {
-    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
-    _register += 5; //# pointing to config 4
+    if (length + fifo_frame_size > BMA400_FIFO_SIZE)
+        fifo_overruns++;
+
+    uint16_t space = block.capacity - block.count;
+    if ((uint32_t)space * fifo_frame_size < length)
+        length = space * fifo_frame_size; //# the rest stays in the FIFO
+    else if (fifo_time_enabled && length > 0)
+        length += 4; //# sensor time frame is appended once the FIFO is empty
+
+    drain.remaining = length;
+    drain.input = block.capacity * 6;
+    drain.pending = 0;
+    drain.size = 0;
+    drain.end = false;
+    return isFifoDrainPending(block, drain);
+}
+
+BMA400::bus_status_t BMA400::stepFifoDrain(sample_block_t &block, fifo_drain_t &drain)
+{
+    uint8_t *bytes = (uint8_t *)block.values;
+    bus_status_t status = bus_status_t::BUS_OK;
+    uint16_t consumed = 0;
+
+    if (drain.size == 0)
+    {
+        uint16_t length = getFifoFillLength(block, drain.pending, drain.remaining);
+        if (length > 0)
+        {
+            //# raw bytes right at the end of the block, the decoded samples never catch up with them
+            uint16_t start = block.capacity * 6 - length - drain.pending;
+            memmove(bytes + start, bytes + drain.input, drain.pending);
+            drain.input = start;
+            status = read(BMA400_REG_FIFO_DATA, length, bytes + start + drain.pending);
+            if (status != bus_status_t::BUS_OK)
+                return status; //# nothing consumed, the step can be repeated
+            drain.remaining -= length;
+
+            block.count += decodeFifo(bytes + start, drain.pending + length, block.values + block.count * 3,
+                                      block.capacity - block.count, &block.sensor_time, consumed, drain.end);
+            drain.input = start + consumed;
+            drain.pending = drain.pending + length - consumed;
+            return status;
+        }
+
+        //# the last samples of the block (and an incomplete frame) go frame by frame through a small buffer
+        memcpy(drain.frame, bytes + drain.input, drain.pending);
+        drain.size = drain.pending;
+        drain.pending = 0;
+        if (drain.size == 0)
+        {
+            status = read(BMA400_REG_FIFO_DATA, 1, drain.frame);
+            if (status != bus_status_t::BUS_OK)
+                return status;
+            drain.size = 1;
+            drain.remaining--;
+            return status;
+        }
+    }
 
-    for (uint8_t i = 0; i < 6; i++)
+    uint8_t frame_size = getFifoFrameSize(drain.frame[0]);
+    if (frame_size > drain.size)
     {
-        write(_register, values[i]);
-        _register++;
+        status = read(BMA400_REG_FIFO_DATA, frame_size - drain.size, drain.frame + drain.size);
+        if (status != bus_status_t::BUS_OK)
+            return status;
+        drain.remaining = drain.remaining > frame_size - drain.size ? drain.remaining - (frame_size - drain.size) : 0;
     }
+
+    block.count += decodeFifo(drain.frame, frame_size, block.values + block.count * 3,
+                              block.capacity - block.count, &block.sensor_time, consumed, drain.end);
+    drain.size = 0;
+    return status;
 }
 
-/*!
- *  @brief  Use current acceleration values to Manually updating the reference acceleration
- *  @param  interrupt target interrupt. it has to be either ADV_GENERIC_INTERRUPT_1 or ADV_GENERIC_INTERRUPT_2
- */
-void BMA400::SetGenericInterruptReference(interrupt_source_t interrupt)
+bool BMA400::isFifoDrainPending(const sample_block_t &block, const fifo_drain_t &drain)
 {
-    uint8_t data[6] = {0};
-    read(BMA400_REG_ACC_DATA, 6, data);
-    uint8_t _register = interrupt == interrupt_source_t::ADV_GENERIC_INTERRUPT_1 ? BMA400_REG_GEN_INT_1_CONFIG : BMA400_REG_GEN_INT_2_CONFIG;
-    _register += 5; //# pointing to config 4
+    return !drain.end && block.count < block.capacity &&
+           (drain.remaining > 0 || drain.pending > 0 || drain.size > 0);
+}
 
-    for (uint8_t i = 0; i < 6; i++)
-    {
-        write(_register, data[i]);
-        _register++;
-    }
+uint16_t BMA400::getFifoFillLength(const sample_block_t &block, uint16_t pending, uint16_t remaining)
+{
+    //# m frames are decoded in place if m * max(frame, 6) bytes are free, plus room for an
+    //# incomplete frame carried over (< 8) and for completing one at the end (6)
+    uint16_t free = (block.capacity - block.count) * 6;
+    uint16_t unit = fifo_frame_size > 6 ? fifo_frame_size : 6;
+    if (free < unit + 14 + pending)
+        return 0;
+
+    uint16_t length = (free - 14 - pending) / unit * fifo_frame_size;
+
+    uint16_t chunk = GetMaxTransferSize();
+    if (chunk > fifo_frame_size)
+        chunk -= chunk % fifo_frame_size;
+    if (length > chunk)
+        length = chunk;
+
+    return length > remaining ? remaining : length;
 }
 
-/*!
- *  @brief  Enabling/Disabling the step detector interrupt and step counter
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  enable true to enable the interrupt (counter)
- */
-void BMA400::ConfigureStepDetectorCounter(bool enable, interrupt_pin_t pin)
+uint8_t BMA400::getFifoFrameSize(uint8_t header)
 {
-    if (enable)
+    if ((header & 0xE1) == 0x80 && (header & 0x0E)) //# data frame
     {
-        set(BMA400_REG_INT_CONFIG_1, 0);
-        LinkToInterruptPin(interrupt_source_t::ADV_STEP_DETECTOR_COUNTER, pin);
+        uint8_t size = 1;
+        for (uint8_t axis = 0; axis < 3; axis++)
+            if (header & (0x02 << axis))
+                size += (header & 0x10) ? 1 : 2;
+        return size;
     }
-    else
-        unset(BMA400_REG_INT_CONFIG_1, 0);
+    if (header == 0xA0) //# sensor time frame
+        return 4;
+    if (header == 0x48) //# control frame
+        return 2;
+    return 1; //# empty or unknown frame
 }
 
-/*!
- *  @brief  Getting the total steps counted so far. 
- *  @return total steps counted
- */
-uint32_t BMA400::GetTotalSteps()
+bool BMA400::selectChannel()
 {
-    uint32_t value;
-    uint8_t values[3] = {0};
-    read(BMA400_REG_STEP_CNT0, 3, values);
-    value = values[0] + values[1] * 256 + values[2] * 256 * 256;
-    return value;
+    return mux == nullptr || mux->Select(mux_channel);
 }
 
-/*!
- *  @brief  Reseting the total steps counted so far. 
- *  @return true if reset step counter is successfully sent
- */
-bool BMA400::ResetStepCounter()
+BMA400::operation_t *BMA400::enqueue(operation_type_t type, uint8_t _register, operation_callback_t callback, void *context)
 {
-    return ExecuteCommand(command_t::CMD_RESET_STEP_CNT);
+    if (queue_count >= BMA400_QUEUE_SIZE)
+        return nullptr;
+
+    operation_t *op = &queue[(queue_head + queue_count) % BMA400_QUEUE_SIZE];
+    memset(op, 0, sizeof(operation_t));
+    op->type = type;
+    op->_register = _register;
+    op->callback = callback;
+    op->context = context;
+    queue_count++;
+    return op;
 }
 
-/*!
- *  @brief  Configures Activity change Interrupt
- *  @param  threshold threshold - raw value
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  enable true if enables interrupt otherwise it disables the interrupt
- *  @param  observation_number number of observations generates the interrupt
- *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
- *  @param  enableX enables interrupt on X Axis
- *  @param  enableY enables interrupt on Y Axis
- *  @param  enableZ enables interrupt on Z Axis
- */
-void BMA400::ConfigureActivityChangeInterrupt(bool enable,
-                                              interrupt_pin_t pin,
-                                              uint8_t threshold,
-                                              activity_change_observation_number_t observation_number,
-                                              interrupt_data_source_t data_source,
-                                              bool enableX, bool enableY, bool enableZ)
+void BMA400::chain(operation_type_t type, uint8_t _register, uint8_t value, uint8_t mask)
 {
-    if (!enable) //# Just disable the interrupt
+    operation_t *op = enqueue(type, _register, nullptr, nullptr);
+    op->value = value;
+    op->mask = mask;
+    op->chained = true;
+}
+
+bool BMA400::raiseDataRate(uint8_t *config, uint8_t odr)
+{
+    if ((config[2] == 0x04) | (config[2] == 0x08)) //# filter 2, fixed 100Hz (ODR 0x08)
     {
-        unset(BMA400_REG_INT_CONFIG_1, 4);
-        return;
+        if (odr <= 0x08)
+            return false;
+        config[0] &= 0x7F; //# filter 1 with 0.48x bandwidth
+        config[2] &= 0xF3;
     }
+    else if ((config[1] & 0x0F) >= odr)
+        return false;
 
-    //# Wiring Interrupt to Interrupt pins
-    LinkToInterruptPin(interrupt_source_t::ADV_ACTIVITY_CHANGE, pin);
-
-    set(BMA400_REG_INT_CONFIG_1, 4);
-    write(BMA400_REG_ACT_CHNG_INT_CONFIG_0, threshold);
+    config[1] = (config[1] & 0xF0) | odr;
+    return true;
+}
 
+void BMA400::encodeGenericInterrupt(
+    generic_interrupt_reference_update_t reference,
+    generic_interrupt_mode_t mode,
+    uint8_t threshold, uint16_t duration,
+    generic_interrupt_hysteresis_amplitude_t hystersis,
+    interrupt_data_source_t data_source,
+    bool enableX, bool enableY, bool enableZ,
+    bool all_combined, uint8_t *config)
+{
+    //# config 0 register
     uint8_t val = 0;
-
-    switch (observation_number)
+    switch (hystersis)
     {
-    case activity_change_observation_number_t::OBSERVATION_32:
+    case generic_interrupt_hysteresis_amplitude_t::AMP_0mg:
         // Do nothing
         break;
 
-    case activity_change_observation_number_t::OBSERVATION_64:
+    case generic_interrupt_hysteresis_amplitude_t::AMP_24mg:
         val |= 0x01;
         break;
 
-    case activity_change_observation_number_t::OBSERVATION_128:
+    case generic_interrupt_hysteresis_amplitude_t::AMP_48mg:
         val |= 0x02;
         break;
 
-    case activity_change_observation_number_t::OBSERVATION_256:
+    case generic_interrupt_hysteresis_amplitude_t::AMP_96mg:
         val |= 0x03;
         break;
-
-    case activity_change_observation_number_t::OBSERVATION_512:
-        val |= 0x04;
-        break;
-    }
-
-    if (data_source == interrupt_data_source_t::ACC_FILT_2)
-        val |= 0x10;
-
-    if (enableX)
-        val |= 0x20;
-
-    if (enableY)
-        val |= 0x40;
-
-    if (enableZ)
-        val |= 0x80;
-
-    write(BMA400_REG_ACT_CHNG_INT_CONFIG_1, val);
-}
-
-/*!
- *  @brief  Configures Activity change Interrupt
- *  @param  threshold threshold - in mg
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  enable true if enables interrupt otherwise it disables the interrupt
- *  @param  observation_number number of observations generates the interrupt
- *  @param  data_source data source is used to monitor the acceleration. Acc Filt 2 is recommended
- *  @param  enableX enables interrupt on X Axis
- *  @param  enableY enables interrupt on Y Axis
- *  @param  enableZ enables interrupt on Z Axis
- */
-void BMA400::ConfigureActivityChangeInterrupt(bool enable,
-                                              interrupt_pin_t pin,
-                                              float threshold,
-                                              activity_change_observation_number_t observation_number,
-                                              interrupt_data_source_t data_source,
-                                              bool enableX, bool enableY, bool enableZ)
-{
-    if (!enable) //# Just disable the interrupt
-    {
-        unset(BMA400_REG_INT_CONFIG_1, 4);
-        return;
     }
 
-    //# Wiring Interrupt to Interrupt pins
-    LinkToInterruptPin(interrupt_source_t::ADV_ACTIVITY_CHANGE, pin);
-
-    set(BMA400_REG_INT_CONFIG_1, 4);
-    threshold /= 8.0;
-    threshold = round(threshold);
-    write(BMA400_REG_ACT_CHNG_INT_CONFIG_0, (uint8_t)threshold);
-
-    uint8_t val = 0;
-
-    switch (observation_number)
+    switch (reference)
     {
-    case activity_change_observation_number_t::OBSERVATION_32:
+    case generic_interrupt_reference_update_t::MANUAL_UPDATE:
         // Do nothing
         break;
 
-    case activity_change_observation_number_t::OBSERVATION_64:
-        val |= 0x01;
-        break;
-
-    case activity_change_observation_number_t::OBSERVATION_128:
-        val |= 0x02;
+    case generic_interrupt_reference_update_t::ONETIME_UPDATE:
+        val |= 0x04;
         break;
 
-    case activity_change_observation_number_t::OBSERVATION_256:
-        val |= 0x03;
+    case generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILTx:
+        val |= 0x08;
         break;
 
-    case activity_change_observation_number_t::OBSERVATION_512:
-        val |= 0x04;
+    case generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILT_LP:
+        val |= 0x0C;
         break;
     }
 
@@ -1672,67 +3766,33 @@ void BMA400::ConfigureActivityChangeInterrupt(bool enable,
     if (enableZ)
         val |= 0x80;
 
-    write(BMA400_REG_ACT_CHNG_INT_CONFIG_1, val);
+    config[0] = val;
+
+    //# config 1 register
+    val = 0;
+
+    if (all_combined)
+        val |= 0x01;
+
+    if (mode == generic_interrupt_mode_t::ACTIVITY_DETECTION)
+        val |= 0x02;
+
+    config[1] = val;
+
+    //# config 2 (threshold), config 3 and config 31 (duration MSB, LSB) registers
+    config[2] = threshold;
+    config[3] = (uint8_t)(duration >> 8);
+    config[4] = (uint8_t)duration;
 }
 
-/*!
- *  @brief  Configures Single and double tap interrupts
- *  @param  enableSingleTap true enables single tap interrupt otherwise it disables the interrupt
- *  @param  enableDoubleTap true enables double tap interrupt otherwise it disables the interrupt
- *  @param  axis tap axis can be either X, Y, or Z. use tap_axis_t data def
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  mode Interrupt mode. On Activity or On Inactivity
- *  @param  sensitivity sensitivity level to tap ranged from 7 (highest) to 0 (lowest). use tap_sensitivity_level_t type def 
- *  @param  pick_to_pick_interval maximum time between upper and lower peak of valid taps (in data samples). use tap_max_pick_to_pick_interval_t data type
- *  @param  quiet_interval Minimum quiet time (no tap) between two consecutive taps (in data samples). use tap_min_quiet_between_taps_t data type
- *  @param  double_taps_time Mininum time between two taps in a double tap (in data samples). use tap_min_quiet_inside_double_taps_t data type
- */
-void BMA400::ConfigureTapInterrupt(
-    bool enableSingleTap, bool enableDoubleTap,
+void BMA400::encodeTapInterrupt(
     tap_axis_t axis,
-    interrupt_pin_t pin,
     tap_sensitivity_level_t sensitivity,
     tap_max_pick_to_pick_interval_t pick_to_pick_interval,
     tap_min_quiet_between_taps_t quiet_interval,
-    tap_min_quiet_inside_double_taps_t double_taps_time)
+    tap_min_quiet_inside_double_taps_t double_taps_time,
+    uint8_t *config)
 {
-
-    if (!enableSingleTap & !enableDoubleTap)
-    {
-        unset(BMA400_REG_INT_CONFIG_1, 2);
-        unset(BMA400_REG_INT_CONFIG_1, 3);
-        return; //# Just disable both interrupts
-    }
-
-    //# Wiring Interrupt to Interrupt pins
-    LinkToInterruptPin(interrupt_source_t::ADV_SINGLE_TAP, pin);
-
-    //# Force increasing the ODR to 200Hz
-    output_data_rate_t rate = GetDataRate();
-    if ((rate == output_data_rate_t::Filter1_024x_12Hz) |
-        (rate == output_data_rate_t::Filter1_024x_25Hz) |
-        (rate == output_data_rate_t::Filter1_024x_50Hz) |
-        (rate == output_data_rate_t::Filter1_024x_100Hz))
-        SetDataRate(output_data_rate_t::Filter1_024x_200Hz);
-    else if ((rate == output_data_rate_t::Filter1_048x_12Hz) |
-             (rate == output_data_rate_t::Filter1_048x_25Hz) |
-             (rate == output_data_rate_t::Filter1_048x_50Hz) |
-             (rate == output_data_rate_t::Filter1_048x_100Hz) |
-             (rate == output_data_rate_t::Filter2_100Hz) |
-             (rate == output_data_rate_t::Filter2_100Hz_LPF_1Hz))
-        SetDataRate(output_data_rate_t::Filter1_048x_200Hz);
-
-    //# Enabling the interrupts
-    if (enableSingleTap)
-        set(BMA400_REG_INT_CONFIG_1, 2);
-    else
-        unset(BMA400_REG_INT_CONFIG_1, 2);
-
-    if (enableDoubleTap)
-        set(BMA400_REG_INT_CONFIG_1, 3);
-    else
-        unset(BMA400_REG_INT_CONFIG_1, 3);
-
     uint8_t val = (uint8_t)sensitivity;
 
     switch (axis)
@@ -1750,7 +3810,7 @@ void BMA400::ConfigureTapInterrupt(
         break;
     }
 
-    write(BMA400_REG_TAP_CONFIG_0, val);
+    config[0] = val;
 
     val = (uint8_t)pick_to_pick_interval;
 
@@ -1784,232 +3844,31 @@ void BMA400::ConfigureTapInterrupt(
         break;
 
     case tap_min_quiet_inside_double_taps_t::MIN_QUIET_DT_12_SAMPLES:
-        val |= 0x10;
-        break;
-
-    case tap_min_quiet_inside_double_taps_t::MIN_QUIET_DT_16_SAMPLES:
-        val |= 0x10;
-        break;
-    }
-
-    write(BMA400_REG_TAP_CONFIG_1, val);
-}
-
-/*!
- *  @brief  Configures Orientation Changed Interrupt
- *  @param  enable  set true to enable the interrupt
- *  @param  enableX enables interrupt on X Axis
- *  @param  enableY enables interrupt on Y Axis
- *  @param  enableZ enables interrupt on Z Axis
- *  @param  pin wires the interrupt with any/both INT Pin 1 and INT Pin 2
- *  @param  source  data source is used as input for the orientation change detection. 
- * see orientation_reference_update_data_source_t for mode details
- *  @param  reference_update_mode   mode of updating the orientation refernce vector (acceleration). 
- * see orientation_reference_update_data_source_t for more details
- *  @param  threshold   Threshold of orientation change will generate interrupt (raw value) - 1 LSB = 8 mg
- *  @param  duration    Minimum duration of the new orientation will generate interrupt (raw value) - 1 LSB = 10ms
- */
-void BMA400::ConfigureOrientationChangeInterrupt(
-    bool enable,
-    bool enableX, bool enableY, bool enableZ,
-    interrupt_pin_t pin,
-    orientation_change_data_source_t source,
-    orientation_reference_update_data_source_t reference_update_mode,
-    uint8_t threshold,
-    uint8_t duration)
-{
-    if (!enable) //# Just disable the interrupt
-    {
-        unset(BMA400_REG_INT_CONFIG_0, 1);
-        return;
-    }
-
-    //# enable the interrupt
-    set(BMA400_REG_INT_CONFIG_0, 1);
-
-    //# Wiring Interrupt to Interrupt pins
-    LinkToInterruptPin(interrupt_source_t::ADV_ORIENTATION_CHANGE, pin);
-
-    uint8_t val;
-    switch (reference_update_mode)
-    {
-    case orientation_reference_update_data_source_t::ORIENT_UPDATE_MANUAL:
-        val = 0x00;
-        break;
-
-    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ:
-        val = 0x04;
-        break;
-
-    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ_LP_1HZ:
-        val = 0x08;
-        break;
-    }
-
-    if (source == orientation_change_data_source_t::ORIENT_UPDATE_ACC_FILT_2_100HZ_LP_1HZ)
-        val |= 0x10;
-
-    if (enableX)
         val |= 0x20;
-
-    if (enableY)
-        val |= 0x40;
-
-    if (enableZ)
-        val |= 0x80;
-
-    write(BMA400_REG_ORIENT_CONFIG_0, val);
-    write(BMA400_REG_ORIENT_CONFIG_1, threshold);
-    write(BMA400_REG_ORIENT_CONFIG_3, duration);
-}
-
-/*!
- *  @brief  Configures Orientation Changed Interrupt
- *  @param  enable  set true to enable the interrupt
- *  @param  enableX enables interrupt on X Axis
- *  @param  enableY enables interrupt on Y Axis
- *  @param  enableZ enables interrupt on Z Axis
- *  @param  source  data source is used as input for the orientation change detection. 
- * see orientation_reference_update_data_source_t for mode details
- *  @param  reference_update_mode   mode of updating the orientation refernce vector (acceleration). 
- * see orientation_reference_update_data_source_t for more details
- *  @param  threshold   Threshold of orientation change will generate interrupt (in mg scale)
- *  @param  duration    Minimum duration of the new orientation will generate interrupt (in ms scale)
- */
-void BMA400::ConfigureOrientationChangeInterrupt(
-    bool enable,
-    bool enableX, bool enableY, bool enableZ,
-    interrupt_pin_t pin,
-    orientation_change_data_source_t source,
-    orientation_reference_update_data_source_t reference_update_mode,
-    float threshold,
-    float duration)
-{
-    if (!enable) //# Just disable the interrupt
-    {
-        unset(BMA400_REG_INT_CONFIG_0, 1);
-        return;
-    }
-
-    //# enable the interrupt
-    set(BMA400_REG_INT_CONFIG_0, 1);
-
-    uint8_t val;
-    switch (reference_update_mode)
-    {
-    case orientation_reference_update_data_source_t::ORIENT_UPDATE_MANUAL:
-        val = 0x00;
-        break;
-
-    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ:
-        val = 0x04;
         break;
 
-    case orientation_reference_update_data_source_t::ORIENT_UPDATE_AUTO_ACC_FILT_2_100HZ_LP_1HZ:
-        val = 0x08;
+    case tap_min_quiet_inside_double_taps_t::MIN_QUIET_DT_16_SAMPLES:
+        val |= 0x30;
         break;
     }
 
-    if (source == orientation_change_data_source_t::ORIENT_UPDATE_ACC_FILT_2_100HZ_LP_1HZ)
-        val |= 0x10;
-
-    if (enableX)
-        val |= 0x20;
-
-    if (enableY)
-        val |= 0x40;
-
-    if (enableZ)
-        val |= 0x80;
-
-    write(BMA400_REG_ORIENT_CONFIG_0, val);
-
-    threshold /= 8;
-    val = threshold > 255 ? 255 : (uint8_t)threshold;
-    write(BMA400_REG_ORIENT_CONFIG_1, val);
-
-    duration /= 10;
-    val = duration > 255 ? 255 : (uint8_t)duration;
-    write(BMA400_REG_ORIENT_CONFIG_3, val);
-}
-
-/*!
- *  @brief  Sets reference vector(acceleration) for Orientation Changed Interrupt
- *  @param  values  Address of arrary 8bit values (length >= 6) includes the values as follows
- * X(LSB) X(MSB) Y(LSB) Y(MSB) Z(LSB) Z(MSB) 
- */
-void BMA400::SetOrientationReference(uint8_t *values)
-{
-    uint8_t _register = BMA400_REG_ORIENT_CONFIG_4;
-    for (uint8_t i = 0; i < 6; i++)
-    {
-        write(_register, values[i]);
-        _register++;
-    }
-}
-
-/*!
- *  @brief  Automatically Use current values to set reference vector(acceleration) for Orientation Changed Interrupt
- */
-void BMA400::SetOrientationReference()
-{
-    uint8_t data[6] = {0};
-    read(BMA400_REG_ACC_DATA, 6, data);
-    uint8_t _register = BMA400_REG_ORIENT_CONFIG_4;
-    for (uint8_t i = 0; i < 6; i++)
-    {
-        write(_register, data[i]);
-        _register++;
-    }
-}
-
-//* Private methods
-void BMA400::read(uint8_t _register, uint8_t length, uint8_t *values)
-{
-    wire->beginTransmission(address);
-    wire->write(_register);
-    wire->endTransmission();
-    wire->requestFrom(address, length);
-    for (uint8_t i = 0; i < length; i++)
-        values[i] = wire->read();
-}
-
-uint8_t BMA400::read(uint8_t _register)
-{
-    wire->beginTransmission(address);
-    wire->write(_register);
-    wire->endTransmission();
-    wire->requestFrom(address, (uint8_t)1);
-    return wire->read();
-}
-
-void BMA400::write(uint8_t _register, const uint8_t &value)
-{
-    wire->beginTransmission(address);
-    wire->write((uint8_t)_register);
-    wire->write((uint8_t)value);
-    wire->endTransmission();
-}
-
-void BMA400::write(uint8_t _register, const uint8_t &value, const uint8_t &mask)
-{
-    uint8_t val = (read(_register) & mask) | value;
-    wire->beginTransmission(address);
-    wire->write((uint8_t)_register);
-    wire->write((uint8_t)val);
-    wire->endTransmission();
+    config[1] = val;
 }
 
 void BMA400::set(uint8_t _register, const uint8_t &_bit)
 {
+    BeginTransaction();
     uint8_t value = read(_register);
     value |= (1 << _bit);
     write(_register, value);
+    EndTransaction();
 }
 
 void BMA400::unset(uint8_t _register, const uint8_t &_bit)
 {
+    BeginTransaction();
     uint8_t value = read(_register);
     value &= ~(1 << _bit);
     write(_register, value);
+    EndTransaction();
 }
\ No newline at end of file
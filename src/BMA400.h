@@ -10,6 +10,8 @@
  *  Find more detail on the sensor on https://www.bosch-sensortec.com/products/motion-sensors/accelerometers/bma400/
  *
  *  This library is only supporting I2C interface not SPI.
+ *  Besides Arduino TwoWire any I2C transport can be used by implementing BMA400Interface
+ *  (see BMA400LinuxI2C for Linux i2c-dev).
  *
  *  @section author Author
  *
@@ -21,18 +23,35 @@
  */
 
 #pragma once
+#if defined(ARDUINO)
 #include <Arduino.h>
 #include <Wire.h>
+#else
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+//# Arduino timing functions, provided by the platform transport (e.g. BMA400LinuxI2C.cpp)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+#endif
 
 #define BMA400_REG_CHIP_ID 0x00
 #define BMA400_REG_STATUS 0x03
 #define BMA400_REG_ACC_DATA 0x04
+#define BMA400_REG_SENSOR_TIME_0 0x0A
 #define BMA400_REG_EVENT 0x0D
 #define BMA400_REG_INT_STAT_0 0x0E
 #define BMA400_REG_INT_STAT_1 0x0F
 #define BMA400_REG_INT_STAT_2 0x10
 #define BMA400_REG_TEMP_DATA 0x11
+#define BMA400_REG_FIFO_LENGTH_0 0x12
+#define BMA400_REG_FIFO_DATA 0x14
 #define BMA400_REG_STEP_CNT0 0x15
+#define BMA400_REG_STEP_STAT 0x18
 #define BMA400_REG_ACC_CONFIG_0 0x19
 #define BMA400_REG_ACC_CONFIG_1 0x1A
 #define BMA400_REG_ACC_CONFIG_2 0x1B
@@ -42,12 +61,20 @@
 #define BMA400_REG_INT2_MAP 0x22
 #define BMA400_REG_INT12_MAP 0x23
 #define BMA400_REG_INT_IO_CTRL 0x24
+#define BMA400_REG_FIFO_CONFIG_0 0x26
+#define BMA400_REG_FIFO_CONFIG_1 0x27
+#define BMA400_REG_FIFO_CONFIG_2 0x28
 #define BMA400_REG_AUTO_LOW_POW_0 0x2A
 #define BMA400_REG_AUTO_LOW_POW_1 0x2B
+#define BMA400_REG_AUTO_WAKEUP_0 0x2C
+#define BMA400_REG_AUTO_WAKEUP_1 0x2D
+#define BMA400_REG_WKUP_INT_CONFIG_0 0x2F
+#define BMA400_REG_WKUP_INT_CONFIG_1 0x30
+#define BMA400_REG_WKUP_INT_CONFIG_2 0x31
 #define BMA400_REG_ORIENT_CONFIG_0 0x35
 #define BMA400_REG_ORIENT_CONFIG_1 0x36
 #define BMA400_REG_ORIENT_CONFIG_3 0x38
-#define BMA400_REG_ORIENT_CONFIG_4 0x38
+#define BMA400_REG_ORIENT_CONFIG_4 0x39
 #define BMA400_REG_GEN_INT_1_CONFIG 0x3F
 #define BMA400_REG_GEN_INT_2_CONFIG 0x4A
 #define BMA400_REG_ACT_CHNG_INT_CONFIG_0 0x55
@@ -61,9 +88,103 @@
 
 #define BMA400_CHIP_ID 0x90
 
+#define BMA400_FIFO_SIZE 1024
+
+//# largest transaction the platform Wire buffer can hold (can be overridden by the build flags)
+#if !defined(BMA400_MAX_TRANSFER_SIZE)
+#if defined(I2C_BUFFER_LENGTH)
+#define BMA400_MAX_TRANSFER_SIZE I2C_BUFFER_LENGTH
+#elif defined(BUFFER_LENGTH)
+#define BMA400_MAX_TRANSFER_SIZE BUFFER_LENGTH
+#elif defined(ARDUINO)
+#define BMA400_MAX_TRANSFER_SIZE 32
+#else
+#define BMA400_MAX_TRANSFER_SIZE BMA400_FIFO_SIZE
+#endif
+#endif
+
+//# number of operations that can be queued for cooperative mode (see Poll). a queued
+//# interrupt configuration takes up to 5 of them
+#if !defined(BMA400_QUEUE_SIZE)
+#define BMA400_QUEUE_SIZE 6
+#endif
+
+//# staging buffer (stack) used while draining the FIFO
+#if !defined(BMA400_FIFO_BUFFER_SIZE)
+#if BMA400_MAX_TRANSFER_SIZE > 252
+#define BMA400_FIFO_BUFFER_SIZE 252
+#else
+#define BMA400_FIFO_BUFFER_SIZE BMA400_MAX_TRANSFER_SIZE
+#endif
+#endif
+
+//# interrupt telemetry (see GetTelemetry), compiled in by defining BMA400_TELEMETRY
+#if defined(BMA400_TELEMETRY)
+#if !defined(BMA400_TELEMETRY_BUCKETS)
+#define BMA400_TELEMETRY_BUCKETS 8
+#endif
+#if !defined(BMA400_TELEMETRY_RESOLUTION)
+#define BMA400_TELEMETRY_RESOLUTION 128 // us covered by the first latency bucket, doubling per bucket
+#endif
+#endif
+
+class BMA400Interface // I2C transport used instead of TwoWire
+{
+public:
+    virtual ~BMA400Interface() {}
+    virtual bool ReadRegisters(uint8_t address, uint8_t _register, uint8_t *values, uint16_t length) = 0;
+    virtual bool WriteRegisters(uint8_t address, uint8_t _register, const uint8_t *values, uint16_t length) = 0;
+    virtual uint16_t GetMaxTransferSize() { return 0; } // 0 = no limit
+};
+
+class BMA400Mux; // I2C multiplexer shared by sensors (see BMA400Mux.h)
+
+class BMA400Lock // serializes bus transactions of several tasks (see BMA400Lock.h for implementations)
+{
+public:
+    virtual ~BMA400Lock() {}
+    virtual void Lock() = 0;   // must be recursive: the owner may lock again
+    virtual void Unlock() = 0;
+};
+
 class BMA400
 {
 public:
+    typedef enum // status of bus transactions
+    {
+        BUS_OK,              // Transaction succeeded
+        BUS_DATA_TOO_LONG,   // Data does not fit into the transmit buffer
+        BUS_NACK_ADDRESS,    // Sensor did not acknowledge its address
+        BUS_NACK_DATA,       // Sensor did not acknowledge the data
+        BUS_ERROR,           // Other bus error (e.g. arbitration lost) or transport failure
+        BUS_TIMEOUT,         // Bus or retry time budget timed out
+        BUS_SHORT_READ,      // Sensor returned fewer bytes than requested
+        BUS_NOT_INITIALIZED, // No bus interface
+    } bus_status_t;
+
+    typedef struct // bus error counters
+    {
+        uint32_t transactions; // all transactions (including retries)
+        uint32_t errors;       // failed transactions (including retries)
+        uint32_t retries;      // retried transactions
+        uint32_t failures;     // transactions failed after all retries
+        uint32_t timeouts;     // transactions stopped by the time budget
+        uint32_t recoveries;   // calls of the bus recovery handler
+        uint32_t bytes;        // data bytes of all transactions (including retries)
+    } bus_error_counters_t;
+
+    typedef void (*bus_recovery_handler_t)(void);
+
+    typedef void (*operation_callback_t)(bus_status_t status, void *context);
+
+    typedef struct // caller owned block of samples, filled in place (see BMA400BufferPool)
+    {
+        int16_t *values;      // X Y Z X Y Z ...
+        uint16_t capacity;    // number of samples (XYZ triplets) values can hold
+        uint16_t count;       // number of samples stored
+        uint32_t sensor_time; // sensor time read with the last FIFO drain (if enabled in ConfigureFifo)
+    } sample_block_t;
+
     typedef enum // power modes (includes noise rate as well)
     {
         UNKNOWN_MODE,                  // Something most be wrong
@@ -86,6 +207,13 @@ public:
         ON_TIMEOUT_RST_G_INT2 // Auto Low Power ontime and also resets generic interrupt 2 asserted
     } auto_low_power_timeout_mode_t;
 
+    typedef enum // update mode for the wake-up interrupt reference
+    {
+        WAKEUP_UPDATE_MANUAL,    // reference values are updated by the user manually
+        WAKEUP_UPDATE_ONETIME,   // reference values are updated automatically once the sensor goes to low power mode
+        WAKEUP_UPDATE_EVERYTIME, // reference values are updated automatically every time a new sample is available in low power mode
+    } wakeup_reference_update_t;
+
     typedef enum // accelerometer data rate (includes the Bandwidth and data source as well)
     {
         UNKNOWN_RATE,         // Something most be wrong
@@ -116,6 +244,43 @@ public:
         RANGE_16G
     } acceleation_range_t;
 
+    typedef struct // data rate and range in physical units, cached by the driver (see GetRateDescriptor)
+    {
+        output_data_rate_t rate;
+        acceleation_range_t range;
+        float frequency;    // output data rate in Hz
+        float period;       // sample period in ms
+        float bandwidth;    // filter bandwidth in Hz
+        uint16_t lsb_per_g; // 12 bit LSB per g at the range
+    } rate_descriptor_t;
+
+    typedef enum // Activity recognized by the step counter (STEP_STAT)
+    {
+        ACTIVITY_STILL = 0x00,   // no steps
+        ACTIVITY_WALKING = 0x01, // walking
+        ACTIVITY_RUNNING = 0x02, // running
+    } activity_t;
+
+    typedef struct // step counter and activity read in one burst
+    {
+        uint32_t steps;
+        activity_t activity;
+    } step_status_t;
+
+    typedef void (*activity_callback_t)(activity_t previous, activity_t current, uint32_t steps, void *context);
+
+#if defined(BMA400_TELEMETRY)
+    typedef struct // interrupt telemetry (see GetTelemetry)
+    {
+        uint32_t edges;                             // pin edges marked by MarkInterruptEdge
+        uint32_t reads;                             // decoded interrupt status reads
+        uint32_t empty;                             // reads without any interrupt (e.g. spurious edges)
+        uint32_t sources[16];                       // decoded interrupts per interrupt_source_t bit (index 0 is BAS_DATA_READY)
+        uint32_t latency[BMA400_TELEMETRY_BUCKETS]; // edge to decoded event. bucket i is below RESOLUTION << i us, the last is open
+        uint32_t max_latency;                       // in us
+    } telemetry_t;
+#endif
+
     typedef enum // All available interrupt sources
     {
         ALL_INTERRUPTS = 0x0000,                        // for disabling all interrupts purpose only
@@ -250,13 +415,79 @@ public:
 
     } tap_min_quiet_inside_double_taps_t;
 
+#if defined(ARDUINO)
     bool Initialize(TwoWire &_wire = Wire);
     bool Initialize(uint8_t _address, TwoWire &_wire = Wire);
+#endif
+    bool Initialize(BMA400Interface &_bus);
+    bool Initialize(uint8_t _address, BMA400Interface &_bus);
+    bool Initialize(BMA400Mux &_mux, uint8_t channel);
+    bool Initialize(uint8_t _address, BMA400Mux &_mux, uint8_t channel);
+    uint8_t GetMuxChannel();
+    void SetMaxTransferSize(uint16_t size);
+    uint16_t GetMaxTransferSize();
+
+    //# Bus error handling
+    bus_status_t ReadRegisters(uint8_t _register, uint8_t *values, uint16_t length);
+    bus_status_t WriteRegisters(uint8_t _register, const uint8_t *values, uint16_t length);
+    bus_status_t GetLastBusStatus();
+    void ConfigureBusRetry(uint8_t retries, uint16_t backoff = 50, uint32_t timeout = 0);
+    void SetBusRecoveryHandler(bus_recovery_handler_t handler);
+    void GetBusErrorCounters(bus_error_counters_t &counters);
+    void ResetBusErrorCounters();
+#if defined(ARDUINO)
+    static void RecoverBus(uint8_t sda, uint8_t scl);
+#endif
+
+    //# Shared bus access
+    void SetLock(BMA400Lock *lock);
+    void BeginTransaction();
+    void EndTransaction();
+
+    //# Cooperative (non-blocking) mode
+    bool QueueRead(uint8_t _register, uint8_t *values, uint16_t length, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueWrite(uint8_t _register, uint8_t value, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueUpdate(uint8_t _register, uint8_t value, uint8_t mask, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueReadAcceleration(int16_t *values, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueGetInterrupts(interrupt_source_t *interrupts, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueGetTotalSteps(uint32_t *steps, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueGetStepStatus(step_status_t *status, operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueConfigureGenericInterrupt(
+        interrupt_source_t interrupt, bool enable,
+        interrupt_pin_t pin,
+        generic_interrupt_reference_update_t reference,
+        generic_interrupt_mode_t mode,
+        uint8_t threshold, uint16_t duration,
+        generic_interrupt_hysteresis_amplitude_t hystersis,
+        interrupt_data_source_t data_source = interrupt_data_source_t::ACC_FILT_2,
+        bool enableX = true, bool enableY = true, bool enableZ = true,
+        bool all_combined = false, bool ignoreSamplingRateFix = false,
+        operation_callback_t callback = nullptr, void *context = nullptr);
+    bool QueueConfigureTapInterrupt(
+        bool enableSingleTap, bool enableDoubleTap,
+        tap_axis_t axis,
+        interrupt_pin_t pin,
+        tap_sensitivity_level_t sensitivity = tap_sensitivity_level_t::TAP_SENSITIVITY_0,
+        tap_max_pick_to_pick_interval_t pick_to_pick_interval = tap_max_pick_to_pick_interval_t::TAP_MAX_12_SAMPLES,
+        tap_min_quiet_between_taps_t quiet_interval = tap_min_quiet_between_taps_t::MIN_QUIET_80_SAMPLES,
+        tap_min_quiet_inside_double_taps_t double_taps_time = tap_min_quiet_inside_double_taps_t::MIN_QUIET_DT_4_SAMPLES,
+        operation_callback_t callback = nullptr, void *context = nullptr);
+    bool Poll();
+    uint8_t GetQueuedOperations();
+    void ClearQueue();
+
+#if defined(BMA400_TELEMETRY)
+    //# Interrupt telemetry
+    void MarkInterruptEdge();
+    bool GetTelemetry(telemetry_t &telemetry);
+    void ResetTelemetry();
+#endif
     void Setup(const power_mode_t &mode, output_data_rate_t rate, acceleation_range_t range = acceleation_range_t::RANGE_2G);
     power_mode_t GetPowerMode();
     void SetPowerMode(const power_mode_t &mode);
     void ReadAcceleration(int16_t *values);
     void ReadAcceleration(float *values);
+    bool ReadAcceleration(sample_block_t &block);
     bool ExecuteCommand(command_t cmd);
 
     //# Auto Low Power Configuration
@@ -269,12 +500,74 @@ public:
     void SetAutoLowPowerOnTimeout(auto_low_power_timeout_mode_t mode, float timeout_threshold);
     void ConfigureAutoLowPower(bool onDataReady, bool onGenericInterrupt1, auto_low_power_timeout_mode_t mode, float timeout_threshold);
 
+    //# Auto Wake-up Configuration
+    bool GetAutoWakeupOnTimeout();
+    bool GetAutoWakeupOnInterrupt();
+    float GetAutoWakeupTimeoutThreshold();
+    void ConfigureAutoWakeup(bool onTimeout, float timeout_threshold);
+
+    void ConfigureWakeupInterrupt(
+        bool enable,
+        interrupt_pin_t pin,
+        wakeup_reference_update_t reference,
+        uint8_t threshold, uint8_t samples = 1,
+        bool enableX = true, bool enableY = true, bool enableZ = true);
+
+    void ConfigureWakeupInterrupt(
+        bool enable,
+        interrupt_pin_t pin,
+        wakeup_reference_update_t reference,
+        float threshold, uint8_t samples = 1,
+        bool enableX = true, bool enableY = true, bool enableZ = true);
+
+    void SetWakeupReference(int8_t *values);
+    void SetWakeupReference();
+
     //# Filter Configuration
     void SetDataRate(output_data_rate_t rate);
     output_data_rate_t GetDataRate();
 
     void SetRange(acceleation_range_t range);
     acceleation_range_t GetRange();
+    const rate_descriptor_t &GetRateDescriptor();
+    void RefreshRateDescriptor();
+    static float GetRateFrequency(output_data_rate_t rate);
+
+    //# FIFO
+    void ConfigureFifo(
+        bool enableX = true, bool enableY = true, bool enableZ = true,
+        bool use8bit = false,
+        interrupt_data_source_t data_source = interrupt_data_source_t::ACC_FILT_1,
+        bool stopOnFull = false,
+        bool enableTime = false,
+        bool autoFlush = false);
+    void SetFifoWatermark(uint16_t level);
+    uint16_t GetFifoWatermark();
+    uint16_t GetFifoLength();
+    bool FlushFifo();
+    uint16_t ReadFifo(int16_t *values, uint16_t max_samples, uint32_t *sensor_time = nullptr);
+    uint16_t ReadFifo(sample_block_t &block);
+    uint16_t TrimFifo(uint16_t samples);
+    bool QueueReadFifo(sample_block_t &block, operation_callback_t callback = nullptr, void *context = nullptr);
+    uint32_t GetFifoOverruns();
+    void ResetFifoOverruns();
+    uint16_t ConfigureFifoBatching(
+        float max_latency,
+        float resolution = 0,
+        interrupt_pin_t pin = interrupt_pin_t::INT_PIN_1,
+        bool enableX = true, bool enableY = true, bool enableZ = true,
+        interrupt_data_source_t data_source = interrupt_data_source_t::ACC_FILT_1);
+    uint32_t GetSensorTime();
+
+    //# Pre-trigger capture
+    uint16_t ConfigurePreTriggerCapture(
+        bool use8bit = false,
+        interrupt_data_source_t data_source = interrupt_data_source_t::ACC_FILT_1);
+    uint16_t CapturePreTriggerWindow(
+        int16_t *values, uint32_t *timestamps,
+        uint16_t pre_samples, uint16_t post_samples,
+        uint16_t &trigger_index,
+        uint16_t timeout = 1000);
 
     //# Interrupts
     interrupt_source_t GetInterrupts();
@@ -322,6 +615,11 @@ public:
     void ConfigureStepDetectorCounter(bool enable, interrupt_pin_t pin); //TODO: Support for Sensor Position (wrist/none wrist)
     uint32_t GetTotalSteps();
     bool ResetStepCounter();
+    bool GetStepStatus(step_status_t &status);
+    activity_t GetActivity();
+    void SetActivityCallback(activity_callback_t callback, void *context = nullptr);
+    bool UpdateActivity();
+    bool UpdateActivity(interrupt_source_t interrupts);
 
     void ConfigureActivityChangeInterrupt(bool enable,
                                           interrupt_pin_t pin,
@@ -366,15 +664,145 @@ public:
 
     void SetOrientationReference(uint8_t *values);
     void SetOrientationReference();
+    bool GetOrientationReference(int16_t *values);
 
 private:
-    uint8_t address;
-    TwoWire *wire;
+    friend class BMA400Scheduler; // reuses the register decoders
+    typedef enum // queued operations
+    {
+        OP_READ,
+        OP_WRITE,
+        OP_UPDATE,
+        OP_READ_ACCELERATION,
+        OP_READ_INTERRUPTS,
+        OP_READ_STEPS,
+        OP_READ_STEP_STATUS,
+        OP_READ_FIFO,
+        OP_RAISE_RATE,
+    } operation_type_t;
+
+    typedef struct // state of a FIFO drain into a block, advanced one bus transaction at a time
+    {
+        uint16_t remaining; // bytes still to read from the FIFO
+        uint16_t input;     // position of the incomplete frame in the block
+        uint8_t pending;    // bytes of the incomplete frame
+        uint8_t size;       // bytes in frame
+        uint8_t frame[8];   // small buffer for the last samples of the block
+        bool end;           // FIFO is empty
+    } fifo_drain_t;
+
+    typedef struct // queued operation (see Poll)
+    {
+        operation_type_t type;
+        uint8_t _register;
+        uint8_t value;
+        uint8_t mask;
+        union
+        {
+            uint8_t data[6];
+            fifo_drain_t drain;
+        };
+        uint16_t length;
+        uint16_t offset;
+        void *destination;
+        operation_callback_t callback;
+        void *context;
+        bool chained; // the next operation belongs to the same request
+    } operation_t;
 
-    void read(uint8_t _register, uint8_t length, uint8_t *values);
+    uint8_t address;
+#if defined(ARDUINO)
+    TwoWire *wire = nullptr;
+#endif
+    BMA400Interface *bus = nullptr;
+    BMA400Mux *mux = nullptr;
+    uint8_t mux_channel = 0xFF;
+    uint8_t fifo_frame_size = 7;
+    bool fifo_time_enabled = false;
+    float capture_rate = 100;
+    uint16_t max_transfer_size = 0;
+    uint32_t fifo_overruns = 0;
+    rate_descriptor_t rate_descriptor;
+    bool rate_descriptor_valid = false;
+    activity_t activity = activity_t::ACTIVITY_STILL;
+    activity_callback_t activity_callback = nullptr;
+    void *activity_context = nullptr;
+
+    uint8_t bus_retries = 2;
+    uint16_t bus_backoff = 50;
+    uint32_t bus_timeout = 0;
+    bus_recovery_handler_t bus_recovery_handler = nullptr;
+    bus_status_t last_bus_status = bus_status_t::BUS_OK;
+    bus_error_counters_t bus_counters = {0, 0, 0, 0, 0, 0, 0};
+    BMA400Lock *lock = nullptr;
+
+    operation_t queue[BMA400_QUEUE_SIZE];
+    uint8_t queue_head = 0;
+    uint8_t queue_count = 0;
+    bool polling = false;     // Poll is running: a failed transaction schedules its retry instead of waiting
+    uint8_t poll_attempt = 0; // attempt of the retry scheduled by Poll, 0 if none
+    uint32_t poll_start = 0;  // micros() of the first attempt
+    uint32_t poll_resume = 0; // micros() when the retry is due
+
+#if defined(BMA400_TELEMETRY)
+    telemetry_t telemetry = {};
+    volatile uint32_t edge_count = 0;         // written by MarkInterruptEdge only
+    volatile uint32_t edge_time = 0;          // micros() of the last edge
+    uint32_t edge_served = 0;                 // edge count of the last recorded latency
+    uint32_t edge_base = 0;                   // edge count at ResetTelemetry
+    volatile uint16_t telemetry_sequence = 0; // odd while the telemetry is being updated
+#endif
+
+    bus_status_t read(uint8_t _register, uint16_t length, uint8_t *values);
     uint8_t read(uint8_t _register);
     void write(uint8_t _register, const uint8_t &value);
     void write(uint8_t _register, const uint8_t &value, const uint8_t &mask);
+    bus_status_t write(uint8_t _register, uint16_t length, const uint8_t *values);
+    bus_status_t transfer(uint8_t _register, uint16_t length, uint8_t *values, bool isWrite, uint32_t start);
+    bus_status_t retry(uint8_t _register, uint16_t length, uint8_t *values, bool isWrite, uint32_t start);
+    uint32_t getBackoff(uint8_t attempt);
+    bus_status_t readOnce(uint8_t _register, uint16_t length, uint8_t *values);
+    bus_status_t writeOnce(uint8_t _register, const uint8_t *values, uint16_t length);
+    static bus_status_t toBusStatus(uint8_t code);
+    static bool isClearedOnRead(uint8_t _register, uint16_t length);
+    bool selectChannel();
+    operation_t *enqueue(operation_type_t type, uint8_t _register, operation_callback_t callback, void *context);
+    void chain(operation_type_t type, uint8_t _register, uint8_t value, uint8_t mask);
+    static bool raiseDataRate(uint8_t *config, uint8_t odr);
+    static void encodeGenericInterrupt(
+        generic_interrupt_reference_update_t reference,
+        generic_interrupt_mode_t mode,
+        uint8_t threshold, uint16_t duration,
+        generic_interrupt_hysteresis_amplitude_t hystersis,
+        interrupt_data_source_t data_source,
+        bool enableX, bool enableY, bool enableZ,
+        bool all_combined, uint8_t *config);
+    static void encodeTapInterrupt(
+        tap_axis_t axis,
+        tap_sensitivity_level_t sensitivity,
+        tap_max_pick_to_pick_interval_t pick_to_pick_interval,
+        tap_min_quiet_between_taps_t quiet_interval,
+        tap_min_quiet_inside_double_taps_t double_taps_time,
+        uint8_t *config);
+
+    static void decodeAcceleration(const uint8_t *data, int16_t *values);
+    static interrupt_source_t decodeInterrupts(const uint8_t *interrupts);
+    static void decodeStepStatus(const uint8_t *data, step_status_t &status);
+    bool reportActivity(const step_status_t &status);
+#if defined(BMA400_TELEMETRY)
+    void recordInterrupts(interrupt_source_t interrupts);
+    uint32_t getEdgeCount(uint32_t *time = nullptr);
+#endif
+
+    uint16_t decodeFifo(const uint8_t *data, uint16_t length, int16_t *values, uint16_t max_samples,
+                        uint32_t *sensor_time, uint16_t &consumed, bool &end);
+    bool startFifoDrain(sample_block_t &block, fifo_drain_t &drain, uint16_t length);
+    bus_status_t stepFifoDrain(sample_block_t &block, fifo_drain_t &drain);
+    static bool isFifoDrainPending(const sample_block_t &block, const fifo_drain_t &drain);
+    uint16_t getFifoFillLength(const sample_block_t &block, uint16_t pending, uint16_t remaining);
+    static uint8_t getFifoFrameSize(uint8_t header);
+    void setRateDescriptor(output_data_rate_t rate, acceleation_range_t range);
+    void invalidateRateDescriptor(uint8_t _register, uint16_t length);
 
     void set(uint8_t _register, const uint8_t &_bit);
     void unset(uint8_t _register, const uint8_t &_bit);
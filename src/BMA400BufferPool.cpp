@@ -0,0 +1,201 @@
+/*!
+ * @file BMA400BufferPool.cpp
+ *
+ *  Pool of sample blocks for zero-copy streaming with the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400BufferPool.h>
+
+/*!
+ *  @brief  Carving the memory into aligned blocks. All blocks start free
+ *  @param  memory memory owned by the caller for the lifetime of the pool (see BMA400_POOL_SIZE)
+ *  @param  size size of memory in bytes
+ *  @param  samples_per_block number of samples (XYZ triplets) per block
+ *  @return number of blocks (up to BMA400_POOL_BLOCKS)
+ */
+uint8_t BMA400BufferPool::Begin(void *memory, size_t size, uint16_t samples_per_block)
+{
+    uintptr_t start = ((uintptr_t)memory + BMA400_POOL_ALIGNMENT - 1) / BMA400_POOL_ALIGNMENT * BMA400_POOL_ALIGNMENT;
+    uintptr_t end = (uintptr_t)memory + size;
+    size_t stride = ((size_t)samples_per_block * 6 + BMA400_POOL_ALIGNMENT - 1) / BMA400_POOL_ALIGNMENT * BMA400_POOL_ALIGNMENT;
+
+    block_count = 0;
+    free_mask = 0;
+    ready_mask = 0;
+    ready_head = 0;
+    ready_count = 0;
+    if (samples_per_block == 0)
+        return 0;
+
+    while (block_count < BMA400_POOL_BLOCKS && start + stride <= end)
+    {
+        BMA400::sample_block_t &block = blocks[block_count];
+        block.values = (int16_t *)start;
+        block.capacity = samples_per_block;
+        block.count = 0;
+        block.sensor_time = 0;
+        free_mask |= (uint32_t)1 << block_count;
+        block_count++;
+        start += stride;
+    }
+    return block_count;
+}
+
+/*!
+ *  @brief  Setting the lock used when producer and consumer run in different tasks
+ *  @param  _lock lock, e.g. BMA400FreeRTOSLock. nullptr disables locking
+ */
+void BMA400BufferPool::SetLock(BMA400Lock *_lock)
+{
+    lock = _lock;
+}
+
+/*!
+ *  @brief  Taking a free block for filling. The block is emptied
+ *  @return block or nullptr if all blocks are in use
+ */
+BMA400::sample_block_t *BMA400BufferPool::Acquire()
+{
+    BMA400::sample_block_t *block = nullptr;
+
+    acquireLock();
+    for (uint8_t i = 0; i < block_count; i++)
+        if (free_mask & ((uint32_t)1 << i))
+        {
+            free_mask &= ~((uint32_t)1 << i);
+            block = &blocks[i];
+            block->count = 0;
+            break;
+        }
+    releaseLock();
+
+    return block;
+}
+
+/*!
+ *  @brief  Handing a filled block over to the consumers
+ *  @param  block block taken with Acquire
+ *  @return false if the block is not from this pool, free or already submitted
+ */
+bool BMA400BufferPool::Submit(BMA400::sample_block_t *block)
+{
+    int8_t index = indexOf(block);
+    if (index < 0)
+        return false;
+
+    uint32_t bit = (uint32_t)1 << index;
+    bool owned = false;
+
+    acquireLock();
+    if (((free_mask | ready_mask) & bit) == 0) //# only the owner of an acquired block may submit it
+    {
+        ready[(ready_head + ready_count) % BMA400_POOL_BLOCKS] = index;
+        ready_count++;
+        ready_mask |= bit;
+        owned = true;
+    }
+    releaseLock();
+
+    return owned;
+}
+
+/*!
+ *  @brief  Taking the oldest filled block for processing
+ *  @return block or nullptr if no block is ready
+ */
+BMA400::sample_block_t *BMA400BufferPool::Receive()
+{
+    BMA400::sample_block_t *block = nullptr;
+
+    acquireLock();
+    if (ready_count > 0)
+    {
+        block = &blocks[ready[ready_head]];
+        ready_mask &= ~((uint32_t)1 << ready[ready_head]);
+        ready_head = (ready_head + 1) % BMA400_POOL_BLOCKS;
+        ready_count--;
+    }
+    releaseLock();
+
+    return block;
+}
+
+/*!
+ *  @brief  Giving a block back to the pool (after processing, or an unused acquired block)
+ *  @param  block block taken with Receive or Acquire
+ *  @return false if the block is not from this pool, already free or waiting in the ready queue
+ */
+bool BMA400BufferPool::Release(BMA400::sample_block_t *block)
+{
+    int8_t index = indexOf(block);
+    if (index < 0)
+        return false;
+
+    uint32_t bit = (uint32_t)1 << index;
+    bool owned = false;
+
+    acquireLock();
+    if (((free_mask | ready_mask) & bit) == 0) //# a second release would hand the block out twice
+    {
+        free_mask |= bit;
+        owned = true;
+    }
+    releaseLock();
+
+    return owned;
+}
+
+/*!
+ *  @brief  Getting the number of blocks
+ *  @return number of blocks
+ */
+uint8_t BMA400BufferPool::GetBlocks()
+{
+    return block_count;
+}
+
+/*!
+ *  @brief  Getting the number of free blocks
+ *  @return number of free blocks
+ */
+uint8_t BMA400BufferPool::GetFreeBlocks()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < block_count; i++)
+        if (free_mask & ((uint32_t)1 << i))
+            count++;
+    return count;
+}
+
+/*!
+ *  @brief  Getting the number of filled blocks waiting for a consumer
+ *  @return number of ready blocks
+ */
+uint8_t BMA400BufferPool::GetReadyBlocks()
+{
+    return ready_count;
+}
+
+//* Private methods
+int8_t BMA400BufferPool::indexOf(const BMA400::sample_block_t *block)
+{
+    if (block < blocks || block >= blocks + block_count)
+        return -1;
+    return block - blocks;
+}
+
+void BMA400BufferPool::acquireLock()
+{
+    if (lock != nullptr)
+        lock->Lock();
+}
+
+void BMA400BufferPool::releaseLock()
+{
+    if (lock != nullptr)
+        lock->Unlock();
+}
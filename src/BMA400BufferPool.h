@@ -0,0 +1,65 @@
+/*!
+ * @file BMA400BufferPool.h
+ *
+ *  Pool of sample blocks for zero-copy streaming with the BMA400 library.
+ *
+ *  The pool carves caller provided memory (no heap) into cache line aligned blocks.
+ *  A block is owned by exactly one side at a time:
+ *  - Acquire: free block -> producer, which fills it in place (BMA400::ReadFifo / ReadAcceleration with a block)
+ *  - Submit: producer -> ready queue (oldest first)
+ *  - Receive: ready queue -> consumer, which processes the samples where they are
+ *  - Release: consumer -> free
+ *
+ *  Producer and consumer may run in different tasks if a lock is set (SetLock).
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#ifndef BMA400_POOL_BLOCKS
+#define BMA400_POOL_BLOCKS 4 // maximum number of blocks (up to 32)
+#endif
+
+#ifndef BMA400_POOL_ALIGNMENT
+#define BMA400_POOL_ALIGNMENT 32 // block alignment in bytes, cache line of the ESP32
+#endif
+
+// bytes of memory needed for a pool of blocks x samples
+#define BMA400_POOL_SIZE(blocks, samples) \
+    ((blocks) * (((samples) * 6 + BMA400_POOL_ALIGNMENT - 1) / BMA400_POOL_ALIGNMENT * BMA400_POOL_ALIGNMENT) + BMA400_POOL_ALIGNMENT - 1)
+
+class BMA400BufferPool
+{
+public:
+    uint8_t Begin(void *memory, size_t size, uint16_t samples_per_block);
+    void SetLock(BMA400Lock *lock);
+
+    BMA400::sample_block_t *Acquire();
+    bool Submit(BMA400::sample_block_t *block);
+    BMA400::sample_block_t *Receive();
+    bool Release(BMA400::sample_block_t *block);
+
+    uint8_t GetBlocks();
+    uint8_t GetFreeBlocks();
+    uint8_t GetReadyBlocks();
+
+private:
+    static_assert(BMA400_POOL_BLOCKS <= 32, "BMA400_POOL_BLOCKS is limited to 32 (bit masks)");
+
+    BMA400::sample_block_t blocks[BMA400_POOL_BLOCKS];
+    uint8_t block_count = 0;
+    uint32_t free_mask = 0;  // bit per free block
+    uint32_t ready_mask = 0; // bit per block in the ready queue
+    uint8_t ready[BMA400_POOL_BLOCKS];
+    uint8_t ready_head = 0;
+    uint8_t ready_count = 0;
+    BMA400Lock *lock = nullptr;
+
+    int8_t indexOf(const BMA400::sample_block_t *block);
+    void acquireLock();
+    void releaseLock();
+};
@@ -0,0 +1,209 @@
+/*!
+ * @file BMA400Energy.cpp
+ *
+ *  Energy and current budget estimation for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Energy.h>
+
+#define BMA400_ENERGY_LOW_POWER_RATE 25 // Hz, fixed data rate of the low power modes
+#define BMA400_ENERGY_STATUS_BYTES 3    // INT_STAT_0..2
+#define BMA400_ENERGY_LENGTH_BYTES 2    // FIFO_LENGTH_0..1
+#define BMA400_ENERGY_SAMPLE_BYTES 6    // ACC_DATA X Y Z
+
+//# supply current (uA) per power_mode_t from the datasheet, unknown modes count as the worst case
+static const float BMA400_MODE_CURRENTS[] = {14.5f, 0.2f, 0.85f, 0.93f, 1.1f, 1.35f, 3.5f, 5.8f, 9.5f, 14.5f};
+
+/*!
+ *  @brief  Setting the cost of the bus traffic
+ *  @param  _transaction_time MCU time (us) per transaction without data (addressing, register, restart)
+ *  @param  _byte_time MCU time (us) per data byte
+ *  @param  _active_current MCU current (mA) while the bus is active
+ *  @param  _max_transfer_size largest transaction (bytes), FIFO reads are split into transactions of this size
+ */
+void BMA400Energy::SetBusTiming(float _transaction_time, float _byte_time, float _active_current, uint16_t _max_transfer_size)
+{
+    transaction_time = _transaction_time;
+    byte_time = _byte_time;
+    active_current = _active_current;
+    max_transfer_size = _max_transfer_size > 0 ? _max_transfer_size : 1;
+}
+
+/*!
+ *  @brief  Measuring the bus costs on the target: single byte reads against long reads of the configuration
+ *  registers (no side effects). The maximum transfer size is taken from the sensor
+ *  @param  _sensor initialized BMA400 sensor
+ *  @param  repetitions reads of each length
+ *  @return true if the reads succeeded
+ */
+bool BMA400Energy::Calibrate(BMA400 &_sensor, uint8_t repetitions)
+{
+    uint8_t values[32];
+    uint16_t length = _sensor.GetMaxTransferSize();
+    if (length > sizeof(values))
+        length = sizeof(values);
+    if (length < 2 || repetitions == 0)
+        return false;
+
+    uint32_t start = micros();
+    for (uint8_t i = 0; i < repetitions; i++)
+        if (_sensor.ReadRegisters(BMA400_REG_ACC_CONFIG_0, values, 1) != BMA400::bus_status_t::BUS_OK)
+            return false;
+    float single = (float)(micros() - start) / repetitions;
+
+    start = micros();
+    for (uint8_t i = 0; i < repetitions; i++)
+        if (_sensor.ReadRegisters(BMA400_REG_ACC_CONFIG_0, values, length) != BMA400::bus_status_t::BUS_OK)
+            return false;
+    float burst = (float)(micros() - start) / repetitions;
+
+    byte_time = burst > single ? (burst - single) / (length - 1) : 0;
+    transaction_time = single > byte_time ? single - byte_time : 0;
+    max_transfer_size = _sensor.GetMaxTransferSize();
+    return true;
+}
+
+/*!
+ *  @brief  Getting the MCU time per transaction (set or calibrated)
+ *  @return time in us
+ */
+float BMA400Energy::GetTransactionTime()
+{
+    return transaction_time;
+}
+
+/*!
+ *  @brief  Getting the MCU time per data byte (set or calibrated)
+ *  @return time in us
+ */
+float BMA400Energy::GetByteTime()
+{
+    return byte_time;
+}
+
+/*!
+ *  @brief  Estimating the average budget of a configuration and workload
+ *  @param  workload configuration and read pattern
+ *  @param  estimate receives the estimate
+ */
+void BMA400Energy::Estimate(const energy_workload_t &workload, energy_estimate_t &estimate)
+{
+    estimate.sensor_current = GetSensorCurrent(workload.mode);
+
+    float rate;
+    if (workload.mode == BMA400::power_mode_t::SLEEP)
+        rate = 0;
+    else if (workload.mode >= BMA400::power_mode_t::LOWEST_POWER_WITH_NOISE && workload.mode <= BMA400::power_mode_t::LOW_POWER_LOW_NOISE)
+        rate = BMA400_ENERGY_LOW_POWER_RATE;
+    else
+        rate = BMA400::GetRateFrequency(workload.rate);
+
+    float transactions = 0, bytes = 0;
+    switch (workload.pattern)
+    {
+    case read_pattern_t::READ_POLLING:
+        transactions = workload.poll_rate;
+        bytes = workload.poll_rate * BMA400_ENERGY_SAMPLE_BYTES;
+        break;
+
+    case read_pattern_t::READ_DATA_READY:
+        transactions = rate * 2;
+        bytes = rate * (BMA400_ENERGY_STATUS_BYTES + BMA400_ENERGY_SAMPLE_BYTES);
+        break;
+
+    case read_pattern_t::READ_FIFO:
+    {
+        if (workload.fifo_watermark == 0)
+            break;
+        //# status + length, then the watermark split into transfers (see ReadFifo)
+        float drains = rate * workload.frame_size / workload.fifo_watermark;
+        uint16_t chunks = (workload.fifo_watermark + max_transfer_size - 1) / max_transfer_size;
+        transactions = drains * (2 + chunks);
+        bytes = drains * (BMA400_ENERGY_STATUS_BYTES + BMA400_ENERGY_LENGTH_BYTES + workload.fifo_watermark);
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    if (workload.interrupts != BMA400::interrupt_source_t::ALL_INTERRUPTS)
+    {
+        transactions += workload.event_rate;
+        bytes += workload.event_rate * BMA400_ENERGY_STATUS_BYTES;
+    }
+
+    estimate.transactions = transactions;
+    estimate.bytes = bytes;
+    complete(estimate);
+}
+
+/*!
+ *  @brief  Starting a live measurement from the bus counters of a running sensor
+ *  @param  _sensor initialized BMA400 sensor
+ */
+void BMA400Energy::BeginMeasurement(BMA400 &_sensor)
+{
+    sensor = &_sensor;
+    sensor->GetBusErrorCounters(start_counters);
+    start_time = millis();
+}
+
+/*!
+ *  @brief  Getting the live estimate since BeginMeasurement: bus traffic from the bus counters and the
+ *  sensor current of the current power mode (read from the sensor)
+ *  @param  estimate receives the estimate
+ *  @return false if there is no measurement or no time elapsed
+ */
+bool BMA400Energy::Measure(energy_estimate_t &estimate)
+{
+    uint32_t elapsed = millis() - start_time;
+    if (sensor == nullptr || elapsed == 0)
+        return false;
+
+    BMA400::bus_error_counters_t counters;
+    sensor->GetBusErrorCounters(counters);
+    estimate.sensor_current = GetSensorCurrent(sensor->GetPowerMode());
+    estimate.transactions = (counters.transactions - start_counters.transactions) * 1000.0f / elapsed;
+    estimate.bytes = (counters.bytes - start_counters.bytes) * 1000.0f / elapsed;
+    complete(estimate);
+    return true;
+}
+
+/*!
+ *  @brief  Getting the datasheet supply current of a power mode
+ *  @param  mode power mode
+ *  @return current in uA (worst case for UNKNOWN_MODE)
+ */
+float BMA400Energy::GetSensorCurrent(BMA400::power_mode_t mode)
+{
+    if ((uint8_t)mode >= sizeof(BMA400_MODE_CURRENTS) / sizeof(BMA400_MODE_CURRENTS[0]))
+        return BMA400_MODE_CURRENTS[0];
+    return BMA400_MODE_CURRENTS[mode];
+}
+
+/*!
+ *  @brief  Getting the battery life of an estimate (sensor and bus only)
+ *  @param  estimate estimated budget
+ *  @param  capacity battery capacity in mAh
+ *  @return life in hours
+ */
+float BMA400Energy::GetBatteryLife(const energy_estimate_t &estimate, float capacity)
+{
+    if (estimate.total_current <= 0)
+        return 0;
+    return capacity * 1000 / estimate.total_current;
+}
+
+//* Private methods
+void BMA400Energy::complete(energy_estimate_t &estimate)
+{
+    estimate.bus_time = (estimate.transactions * transaction_time + estimate.bytes * byte_time) / 1000;
+    //# share of the time the bus is active (ms per s / 1000) times mA in uA
+    estimate.bus_current = estimate.bus_time * active_current;
+    estimate.total_current = estimate.sensor_current + estimate.bus_current;
+}
@@ -0,0 +1,83 @@
+/*!
+ * @file BMA400Energy.h
+ *
+ *  Energy and current budget estimation for the BMA400 library.
+ *
+ *  The average current of a configuration is estimated from the datasheet supply
+ *  current of the power mode (see power_mode_t) and the bus traffic of the workload:
+ *  transactions and bytes per second derived from the data rate, the read pattern
+ *  (polling, data ready, FIFO watermark) and the expected interrupt events. The bus
+ *  traffic is converted into MCU bus-active time with per transaction / per byte costs,
+ *  measured on the target by Calibrate (or set with SetBusTiming), and into an average
+ *  current with the MCU active current.
+ *
+ *  Besides estimating a planned configuration, the live estimate of a running sensor is
+ *  taken from the bus counters (see GetBusErrorCounters) between BeginMeasurement and
+ *  Measure, so firmware configurations can be compared for battery life.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+class BMA400Energy
+{
+public:
+    typedef enum // how the application reads the samples
+    {
+        READ_NONE,       // samples are not read (interrupt events only)
+        READ_POLLING,    // acceleration read at a fixed rate
+        READ_DATA_READY, // interrupt status and acceleration read on every data ready interrupt
+        READ_FIFO,       // interrupt status, FIFO length and FIFO data read on every watermark interrupt
+    } read_pattern_t;
+
+    typedef struct // configuration and workload to estimate
+    {
+        BMA400::power_mode_t mode;
+        BMA400::output_data_rate_t rate; // ignored in low power mode (fixed 25Hz)
+        read_pattern_t pattern;
+        uint16_t fifo_watermark; // bytes (READ_FIFO)
+        uint8_t frame_size;      // bytes per FIFO frame, 7 for 12 bit XYZ with header (READ_FIFO)
+        float poll_rate;         // reads per second (READ_POLLING)
+        uint16_t interrupts;     // other enabled interrupt_source_t flags, each event served by a status read
+        float event_rate;        // expected events per second of these interrupts
+    } energy_workload_t;
+
+    typedef struct // estimated average budget
+    {
+        float sensor_current; // uA, datasheet current of the power mode
+        float transactions;   // bus transactions per second
+        float bytes;          // data bytes per second
+        float bus_time;       // MCU bus-active time in ms per second
+        float bus_current;    // uA, MCU active current averaged over the bus-active time
+        float total_current;  // uA, sensor and bus
+    } energy_estimate_t;
+
+    void SetBusTiming(float transaction_time = 80, float byte_time = 22.5f, float active_current = 5,
+                      uint16_t max_transfer_size = BMA400_MAX_TRANSFER_SIZE);
+    bool Calibrate(BMA400 &_sensor, uint8_t repetitions = 8);
+    float GetTransactionTime();
+    float GetByteTime();
+
+    void Estimate(const energy_workload_t &workload, energy_estimate_t &estimate);
+    void BeginMeasurement(BMA400 &sensor);
+    bool Measure(energy_estimate_t &estimate);
+
+    static float GetSensorCurrent(BMA400::power_mode_t mode);
+    static float GetBatteryLife(const energy_estimate_t &estimate, float capacity);
+
+private:
+    float transaction_time = 80; // us per transaction (addressing, register, restart)
+    float byte_time = 22.5f;     // us per data byte (9 bits at 400kHz)
+    float active_current = 5;    // mA of the MCU while the bus is active
+    uint16_t max_transfer_size = BMA400_MAX_TRANSFER_SIZE;
+
+    BMA400 *sensor = nullptr;
+    BMA400::bus_error_counters_t start_counters;
+    uint32_t start_time = 0;
+
+    void complete(energy_estimate_t &estimate);
+};
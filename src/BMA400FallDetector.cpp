@@ -0,0 +1,258 @@
+/*!
+ * @file BMA400FallDetector.cpp
+ *
+ *  Free-fall and impact based fall detection for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400FallDetector.h>
+
+#define BMA400_FALL_IMPACT_WINDOW 1000 // ms after the free fall searched for the impact
+
+/*!
+ *  @brief  Configuring the sensor (8G range, FIFO history of filter 2 data, both generic interrupts) and the detector
+ *  @param  _sensor initialized BMA400 sensor
+ *  @param  _buffer samples (X Y Z) of a capture. 3 x capacity elements
+ *  @param  _capacity samples in a capture. the post-trigger part is 1 s + settle + stillness duration, the rest is history
+ *  @param  pin wires both generic interrupts with any/both INT Pin 1 and INT Pin 2
+ *  @param  _free_fall_threshold acceleration (mg) below which the sensor is in free fall
+ *  @param  free_fall_duration minimum free fall (ms) raising the interrupt
+ *  @param  impact_threshold deviation from gravity (mg, up to 2040) raising the impact interrupt
+ */
+void BMA400FallDetector::Begin(BMA400 &_sensor, int16_t *_buffer, uint16_t _capacity,
+                               BMA400::interrupt_pin_t pin,
+                               float _free_fall_threshold, float free_fall_duration,
+                               float impact_threshold)
+{
+    sensor = &_sensor;
+    buffer = _buffer;
+    capacity = _capacity;
+    capturing = false;
+    count = 0;
+    free_fall_threshold = _free_fall_threshold;
+
+    sensor->SetRange(BMA400::acceleation_range_t::RANGE_8G);
+    lsb_per_g = sensor->GetRateDescriptor().lsb_per_g;
+    sensor->ConfigurePreTriggerCapture(false, BMA400::interrupt_data_source_t::ACC_FILT_2);
+
+    //# free fall: all axes close to a zero reference
+    sensor->ConfigureGenericInterrupt(BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1, true, pin,
+                                      BMA400::generic_interrupt_reference_update_t::MANUAL_UPDATE,
+                                      BMA400::generic_interrupt_mode_t::INACTIVITY_DETECTION,
+                                      free_fall_threshold, free_fall_duration,
+                                      BMA400::generic_interrupt_hysteresis_amplitude_t::AMP_24mg,
+                                      BMA400::interrupt_data_source_t::ACC_FILT_2,
+                                      true, true, true, true);
+    uint8_t zero[6] = {0};
+    sensor->SetGenericInterruptReference(BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1, zero);
+
+    //# impact: any axis far from the low pass filtered gravity
+    sensor->ConfigureGenericInterrupt(BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_2, true, pin,
+                                      BMA400::generic_interrupt_reference_update_t::EVERYTIME_UPDATE_FROM_ACC_FILT_LP,
+                                      BMA400::generic_interrupt_mode_t::ACTIVITY_DETECTION,
+                                      impact_threshold, 0.0f,
+                                      BMA400::generic_interrupt_hysteresis_amplitude_t::AMP_0mg,
+                                      BMA400::interrupt_data_source_t::ACC_FILT_2);
+}
+
+/*!
+ *  @brief  Setting the software confirmation
+ *  @param  free_fall_duration minimum free fall in ms (0 accepts falls without free fall, e.g. from sitting)
+ *  @param  impact minimum peak magnitude in g
+ *  @param  _stillness maximum deviation (mg) from the mean on every axis after the impact
+ *  @param  _stillness_duration time (ms) the sensor has to stay still
+ *  @param  _settle time (ms) after the impact before the stillness is checked
+ */
+void BMA400FallDetector::ConfigureConfirmation(float free_fall_duration, float impact,
+                                               float _stillness, float _stillness_duration,
+                                               float _settle)
+{
+    min_free_fall = free_fall_duration;
+    min_impact = impact;
+    stillness = _stillness;
+    stillness_duration = _stillness_duration;
+    settle = _settle;
+}
+
+/*!
+ *  @brief  Setting the function called (from Update) for each confirmed fall
+ *  @param  _callback called with the analysis of the fall. nullptr disables it
+ *  @param  _context passed to the callback
+ */
+void BMA400FallDetector::SetCallback(fall_callback_t _callback, void *_context)
+{
+    callback = _callback;
+    context = _context;
+}
+
+/*!
+ *  @brief  Advancing the detector. Call it with the decoded interrupts when an interrupt is served,
+ *  and without interrupts (e.g. every 100 ms) while IsCapturing
+ *  @param  interrupts decoded interrupts (see BMA400::GetInterrupts)
+ *  @return true if a fall was confirmed
+ */
+bool BMA400FallDetector::Update(BMA400::interrupt_source_t interrupts)
+{
+    if (sensor == nullptr || capacity == 0)
+        return false;
+
+    if (!capturing)
+    {
+        const uint16_t triggers = BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1 |
+                                  BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_2;
+        if ((interrupts & triggers) == 0)
+            return false;
+        startCapture();
+    }
+
+    count += sensor->ReadFifo(buffer + count * 3, capacity - count);
+    if (count < capacity)
+        return false;
+
+    capturing = false;
+    analyse();
+    return last_event.confirmed;
+}
+
+/*!
+ *  @brief  Checking if a capture is in progress
+ *  @return true if samples are being collected
+ */
+bool BMA400FallDetector::IsCapturing()
+{
+    return capturing;
+}
+
+/*!
+ *  @brief  Getting the analysis of the last capture, confirmed or not
+ *  @return last event
+ */
+const BMA400FallDetector::fall_event_t &BMA400FallDetector::GetLastEvent()
+{
+    return last_event;
+}
+
+/*!
+ *  @brief  Getting the number of confirmed falls since Begin/ResetStatistics
+ *  @return number of falls
+ */
+uint32_t BMA400FallDetector::GetFalls()
+{
+    return falls;
+}
+
+/*!
+ *  @brief  Getting the number of captures rejected by the software confirmation since Begin/ResetStatistics
+ *  @return number of false alarms
+ */
+uint32_t BMA400FallDetector::GetFalseAlarms()
+{
+    return false_alarms;
+}
+
+/*!
+ *  @brief  Clearing the fall and false alarm counters
+ */
+void BMA400FallDetector::ResetStatistics()
+{
+    falls = 0;
+    false_alarms = 0;
+}
+
+//* Private methods
+uint16_t BMA400FallDetector::getPostSamples()
+{
+    uint32_t post = (uint32_t)(BMA400_FALL_IMPACT_WINDOW + settle + stillness_duration) * (uint32_t)rate / 1000;
+    return post > capacity ? capacity : post;
+}
+
+void BMA400FallDetector::startCapture()
+{
+    //# keeping the newest history that leaves room for the post-trigger samples
+    sensor->TrimFifo(capacity - getPostSamples());
+
+    count = 0;
+    capturing = true;
+}
+
+void BMA400FallDetector::analyse()
+{
+    fall_event_t event = {false, 0, 0, 0, count};
+    int32_t limit = (int32_t)(free_fall_threshold * lsb_per_g / 1000);
+    limit *= limit;
+
+    //# free fall: longest run below the threshold
+    uint16_t run = 0, longest = 0, fall_end = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const int16_t *value = buffer + i * 3;
+        int32_t magnitude = (int32_t)value[0] * value[0] + (int32_t)value[1] * value[1] + (int32_t)value[2] * value[2];
+        run = magnitude < limit ? run + 1 : 0;
+        if (run > longest)
+        {
+            longest = run;
+            fall_end = i + 1;
+        }
+    }
+    event.free_fall = longest * 1000 / rate;
+
+    //# impact: peak after the free fall (anywhere if there was none)
+    uint16_t first = longest > 0 ? fall_end : 0;
+    uint16_t last = longest > 0 ? first + BMA400_FALL_IMPACT_WINDOW * rate / 1000 : count;
+    if (last > count)
+        last = count;
+    int32_t peak = 0;
+    uint16_t impact_index = first;
+    for (uint16_t i = first; i < last; i++)
+    {
+        const int16_t *value = buffer + i * 3;
+        int32_t magnitude = (int32_t)value[0] * value[0] + (int32_t)value[1] * value[1] + (int32_t)value[2] * value[2];
+        if (magnitude > peak)
+        {
+            peak = magnitude;
+            impact_index = i;
+        }
+    }
+    event.impact = sqrt((float)peak) / lsb_per_g;
+
+    //# stillness: every axis within a band once the impact settled
+    uint16_t start = impact_index + settle * rate / 1000;
+    uint16_t needed = stillness_duration * rate / 1000;
+    bool still = false;
+    if (start + needed <= count && needed > 0)
+    {
+        int32_t sum[3] = {0};
+        for (uint16_t i = start; i < start + needed; i++)
+            for (uint8_t axis = 0; axis < 3; axis++)
+                sum[axis] += buffer[i * 3 + axis];
+
+        int32_t deviation = 0;
+        for (uint16_t i = start; i < start + needed; i++)
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                int32_t difference = buffer[i * 3 + axis] - sum[axis] / needed;
+                if (difference < 0)
+                    difference = -difference;
+                if (difference > deviation)
+                    deviation = difference;
+            }
+        event.deviation = deviation * 1000.0f / lsb_per_g;
+        still = event.deviation <= stillness;
+    }
+
+    event.confirmed = event.free_fall >= min_free_fall && event.impact >= min_impact && still;
+    last_event = event;
+
+    if (!event.confirmed)
+    {
+        false_alarms++;
+        return;
+    }
+
+    falls++;
+    if (callback != nullptr)
+        callback(last_event, context);
+}
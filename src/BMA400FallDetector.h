@@ -0,0 +1,84 @@
+/*!
+ * @file BMA400FallDetector.h
+ *
+ *  Free-fall and impact based fall detection for the BMA400 library.
+ *
+ *  Both generic interrupt engines are configured: engine 1 detects free fall (all axes
+ *  below a threshold around a zero reference, inactivity mode, AND combined) and engine 2
+ *  detects impacts (any axis deviating from the low pass filtered gravity, activity mode).
+ *  The FIFO keeps a history of the 100Hz filter 2 data, so when either interrupt fires
+ *  the samples before it are still available (pre-trigger capture).
+ *
+ *  On a trigger the detector collects the history and the following samples without
+ *  blocking (one FIFO read per Update) and confirms the event in software:
+ *  - free fall: longest run of samples with a magnitude below the threshold
+ *  - impact: peak magnitude within 1 s after the free fall
+ *  - stillness: acceleration staying within a band after the impact has settled
+ *  Only confirmed falls are reported to the callback (and by Update), so false alarms
+ *  (e.g. the device being dropped and picked up) do not wake the application.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+class BMA400FallDetector
+{
+public:
+    typedef struct // result of the software confirmation
+    {
+        bool confirmed;
+        uint16_t free_fall; // longest free fall in ms
+        float impact;       // peak magnitude in g
+        float deviation;    // largest deviation (mg) from the mean in the stillness window
+        uint16_t samples;   // samples analysed
+    } fall_event_t;
+
+    typedef void (*fall_callback_t)(const fall_event_t &event, void *context);
+
+    void Begin(BMA400 &sensor, int16_t *buffer, uint16_t capacity,
+               BMA400::interrupt_pin_t pin = BMA400::interrupt_pin_t::INT_PIN_1,
+               float free_fall_threshold = 400, float free_fall_duration = 60,
+               float impact_threshold = 1500);
+    void ConfigureConfirmation(float free_fall_duration = 150, float impact = 2.5,
+                               float stillness = 200, float stillness_duration = 1000,
+                               float settle = 500);
+    void SetCallback(fall_callback_t callback, void *context = nullptr);
+
+    bool Update(BMA400::interrupt_source_t interrupts = BMA400::interrupt_source_t::ALL_INTERRUPTS);
+    bool IsCapturing();
+    const fall_event_t &GetLastEvent();
+
+    uint32_t GetFalls();
+    uint32_t GetFalseAlarms();
+    void ResetStatistics();
+
+private:
+    BMA400 *sensor = nullptr;
+    int16_t *buffer = nullptr;
+    uint16_t capacity = 0;
+    uint16_t count = 0;
+    bool capturing = false;
+    float rate = 100;
+    float lsb_per_g = 256;
+
+    float free_fall_threshold = 400;
+    uint16_t min_free_fall = 150;
+    float min_impact = 2.5;
+    float stillness = 200;
+    uint16_t stillness_duration = 1000;
+    uint16_t settle = 500;
+
+    fall_event_t last_event = {false, 0, 0, 0, 0};
+    uint32_t falls = 0;
+    uint32_t false_alarms = 0;
+    fall_callback_t callback = nullptr;
+    void *context = nullptr;
+
+    uint16_t getPostSamples();
+    void startCapture();
+    void analyse();
+};
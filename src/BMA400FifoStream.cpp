@@ -0,0 +1,155 @@
+/*!
+ * @file BMA400FifoStream.cpp
+ *
+ *  Double/triple buffered FIFO streaming for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400FifoStream.h>
+
+/*!
+ *  @brief  Starting the stream. The FIFO has to be configured (ConfigureFifo/ConfigureFifoBatching)
+ *  @param  _sensor initialized BMA400 sensor
+ *  @param  _pool pool with two (double buffering) or more blocks
+ *  @param  _interval time (ms) between drains once the FIFO was found empty, e.g. the batch latency.
+ *          A drain that filled its block is followed by the next one right away
+ */
+void BMA400FifoStream::Begin(BMA400 &_sensor, BMA400BufferPool &_pool, uint32_t _interval)
+{
+    sensor = &_sensor;
+    pool = &_pool;
+    interval = _interval;
+    current = nullptr;
+    draining = false;
+    stalled = false;
+    drain_now = true;
+    ResetStatistics();
+}
+
+/*!
+ *  @brief  Advancing the stream by at most one bus transaction. Call it from the main loop (or a task)
+ *  @return true if a drain is in progress
+ */
+bool BMA400FifoStream::Update()
+{
+    if (sensor == nullptr)
+        return false;
+
+    if (!draining)
+    {
+        if (!drain_now && millis() - last_drain < interval)
+            return false;
+
+        if (current == nullptr)
+        {
+            current = pool->Acquire();
+            if (current == nullptr)
+            {
+                if (!stalled) //# counting each stall once, not every Update
+                    stalls++;
+                stalled = true;
+                return false;
+            }
+            stalled = false;
+        }
+
+        if (!sensor->QueueReadFifo(*current, completed, this))
+            return false;
+        draining = true;
+        last_drain = millis();
+    }
+
+    sensor->Poll();
+    return draining;
+}
+
+/*!
+ *  @brief  Handing over the partially filled block (e.g. before sleeping or stopping)
+ *  @return false if a drain is in progress or there is nothing to hand over
+ */
+bool BMA400FifoStream::Flush()
+{
+    if (draining || current == nullptr || current->count == 0)
+        return false;
+
+    pool->Submit(current);
+    current = nullptr;
+    blocks++;
+    return true;
+}
+
+/*!
+ *  @brief  Taking the oldest full block for processing. The samples stay where they were decoded
+ *  @return block or nullptr if none is ready
+ */
+BMA400::sample_block_t *BMA400FifoStream::Receive()
+{
+    return pool->Receive();
+}
+
+/*!
+ *  @brief  Giving a processed block back, so it can be filled again
+ *  @param  block block taken with Receive
+ */
+void BMA400FifoStream::Release(BMA400::sample_block_t *block)
+{
+    pool->Release(block);
+}
+
+/*!
+ *  @brief  Getting the number of blocks handed over since Begin/ResetStatistics
+ *  @return number of blocks
+ */
+uint32_t BMA400FifoStream::GetBlocks()
+{
+    return blocks;
+}
+
+/*!
+ *  @brief  Getting the number of times the drain had to wait for a free block (consumer too slow)
+ *  @return number of stalls
+ */
+uint32_t BMA400FifoStream::GetStalls()
+{
+    return stalls;
+}
+
+/*!
+ *  @brief  Getting the number of drains stopped by a bus error
+ *  @return number of errors
+ */
+uint32_t BMA400FifoStream::GetErrors()
+{
+    return errors;
+}
+
+/*!
+ *  @brief  Clearing the block, stall and error counters
+ */
+void BMA400FifoStream::ResetStatistics()
+{
+    blocks = 0;
+    stalls = 0;
+    errors = 0;
+}
+
+//* Private methods
+void BMA400FifoStream::completed(BMA400::bus_status_t status, void *context)
+{
+    BMA400FifoStream *stream = (BMA400FifoStream *)context;
+    stream->draining = false;
+    if (status != BMA400::bus_status_t::BUS_OK)
+        stream->errors++;
+
+    //# a full block means the FIFO may hold more, draining again right away
+    stream->drain_now = stream->current->count >= stream->current->capacity;
+    if (stream->drain_now)
+    {
+        stream->pool->Submit(stream->current);
+        stream->current = nullptr;
+        stream->blocks++;
+    }
+}
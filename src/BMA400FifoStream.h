@@ -0,0 +1,55 @@
+/*!
+ * @file BMA400FifoStream.h
+ *
+ *  Double/triple buffered FIFO streaming for the BMA400 library.
+ *
+ *  The stream drains the FIFO into blocks of a BMA400BufferPool using queued (cooperative)
+ *  reads: every Update call advances the drain by one bus transaction, so the application
+ *  can process a full block (Receive ... Release) while the next one is being filled.
+ *  With two blocks in the pool this is double buffering, with three the consumer may
+ *  hold one block while two are in flight/ready.
+ *
+ *  Full blocks are handed over in order. When no block is free the drain waits (stall)
+ *  and the sensor FIFO keeps buffering. FIFO overruns are counted by the driver
+ *  (BMA400::GetFifoOverruns).
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+#include <BMA400BufferPool.h>
+
+class BMA400FifoStream
+{
+public:
+    void Begin(BMA400 &sensor, BMA400BufferPool &pool, uint32_t interval = 0);
+
+    bool Update();
+    bool Flush();
+    BMA400::sample_block_t *Receive();
+    void Release(BMA400::sample_block_t *block);
+
+    uint32_t GetBlocks();
+    uint32_t GetStalls();
+    uint32_t GetErrors();
+    void ResetStatistics();
+
+private:
+    BMA400 *sensor = nullptr;
+    BMA400BufferPool *pool = nullptr;
+    BMA400::sample_block_t *current = nullptr;
+    bool draining = false;
+    bool stalled = false;
+    uint32_t interval = 0;
+    uint32_t last_drain = 0;
+    bool drain_now = true;
+
+    uint32_t blocks = 0;
+    uint32_t stalls = 0;
+    uint32_t errors = 0;
+
+    static void completed(BMA400::bus_status_t status, void *context);
+};
@@ -0,0 +1,361 @@
+/*!
+ * @file BMA400Gesture.cpp
+ *
+ *  Gesture recognition (shake, flick, custom motions) over acceleration streams for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Gesture.h>
+
+#define BMA400_GESTURE_ABANDONED 0xFFFF
+
+/*!
+ *  @brief  Starting the engine. Templates are cleared
+ *  @param  _decimation number of samples averaged into one feature (e.g. 2 at 100Hz gives 50 features/s)
+ *  @param  _shift right shift of raw LSB to int8 features (4 gives 1/64 g per step at 2G)
+ */
+void BMA400Gesture::Begin(uint8_t _decimation, uint8_t _shift)
+{
+    decimation = _decimation > 0 ? _decimation : 1;
+    shift = _shift;
+    template_count = 0;
+    armed = false;
+    remaining = 0;
+    summed = 0;
+    baseline_valid = false;
+    time = 0;
+    last_gesture = -1;
+    last_distance = 0;
+    matched_features = 0;
+    for (uint8_t axis = 0; axis < 3; axis++)
+        sum[axis] = 0;
+}
+
+/*!
+ *  @brief  Adding a template. The values are not copied and must stay valid
+ *  @param  values features ordered as X Y Z X Y Z ... (see Record)
+ *  @param  length number of features (XYZ triplets), up to BMA400_GESTURE_LENGTH
+ *  @param  threshold maximum mean distance per feature (sum of the absolute XYZ differences) for a match
+ *  @return index of the template (reported to the callback) or -1 if there is no room
+ */
+int8_t BMA400Gesture::AddTemplate(const int8_t *values, uint8_t length, uint8_t threshold)
+{
+    if (template_count >= BMA400_GESTURE_TEMPLATES || length == 0 || length > BMA400_GESTURE_LENGTH)
+        return -1;
+
+    gesture_template_t &gesture = templates[template_count];
+    gesture.values = values;
+    gesture.length = length;
+    uint32_t bound = (uint32_t)threshold * length;
+    gesture.bound = bound >= BMA400_GESTURE_ABANDONED ? BMA400_GESTURE_ABANDONED - 1 : bound;
+    template_count++;
+    resetColumns();
+    return template_count - 1;
+}
+
+/*!
+ *  @brief  Removing all templates
+ */
+void BMA400Gesture::ClearTemplates()
+{
+    template_count = 0;
+}
+
+/*!
+ *  @brief  Selecting the interrupts arming the matcher
+ *  @param  sources combination of interrupt_source_t flags (e.g. generic interrupt 1 in activity mode)
+ *  @param  _hold features after the last trigger during which new matches may start
+ */
+void BMA400Gesture::ConfigureTrigger(uint16_t sources, uint16_t _hold)
+{
+    trigger_sources = sources;
+    hold = _hold;
+}
+
+/*!
+ *  @brief  Setting the function called (from Update) for each recognized gesture
+ *  @param  _callback called with the template index, the mean distance per feature and the duration in samples
+ *  @param  _context passed to the callback
+ */
+void BMA400Gesture::SetCallback(gesture_callback_t _callback, void *_context)
+{
+    callback = _callback;
+    context = _context;
+}
+
+/*!
+ *  @brief  Arming the matcher if any of the trigger interrupts is set
+ *  @param  interrupts decoded interrupts (see BMA400::GetInterrupts)
+ *  @return true if armed by these interrupts
+ */
+bool BMA400Gesture::Trigger(BMA400::interrupt_source_t interrupts)
+{
+    if ((interrupts & trigger_sources) == 0)
+        return false;
+
+    Arm();
+    return true;
+}
+
+/*!
+ *  @brief  Arming the matcher (or extending the hold time) without an interrupt
+ */
+void BMA400Gesture::Arm()
+{
+    if (!armed)
+        resetColumns();
+    armed = true;
+    remaining = hold;
+}
+
+/*!
+ *  @brief  Processing a batch of samples. While idle only the resting baseline is tracked
+ *  @param  samples raw samples ordered as X Y Z X Y Z ...
+ *  @param  count number of samples (XYZ triplets)
+ *  @return number of gestures recognized
+ */
+uint8_t BMA400Gesture::Update(const int16_t *samples, uint16_t count)
+{
+    uint8_t recognized = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        for (uint8_t axis = 0; axis < 3; axis++)
+            sum[axis] += samples[i * 3 + axis];
+        if (++summed < decimation)
+            continue;
+
+        int32_t frame[3];
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            frame[axis] = sum[axis] / decimation;
+            sum[axis] = 0;
+        }
+        summed = 0;
+
+        if (!baseline_valid)
+        {
+            for (uint8_t axis = 0; axis < 3; axis++)
+                baseline[axis] = frame[axis];
+            baseline_valid = true;
+        }
+
+        if (!armed)
+        {
+            for (uint8_t axis = 0; axis < 3; axis++)
+                baseline[axis] += (frame[axis] - baseline[axis]) / 8;
+            continue;
+        }
+
+        int8_t feature[3];
+        quantize(frame, feature);
+        recognized += step(feature);
+    }
+    return recognized;
+}
+
+/*!
+ *  @brief  Processing the samples of a block (e.g. from BMA400FifoStream)
+ *  @param  block block filled by ReadFifo
+ *  @return number of gestures recognized
+ */
+uint8_t BMA400Gesture::Update(const BMA400::sample_block_t &block)
+{
+    return Update(block.values, block.count);
+}
+
+/*!
+ *  @brief  Converting a raw recording of a gesture into a template. The recording must start at rest (the first
+ *  samples are the baseline), the rest before the motion is dropped
+ *  @param  samples raw samples ordered as X Y Z X Y Z ...
+ *  @param  count number of samples (XYZ triplets)
+ *  @param  values receives the features (3 * max_length values)
+ *  @param  max_length maximum number of features
+ *  @return number of features written
+ */
+uint8_t BMA400Gesture::Record(const int16_t *samples, uint16_t count, int8_t *values, uint8_t max_length)
+{
+    int32_t rest[3] = {0};
+    uint8_t length = 0;
+    for (uint16_t i = 0; i + decimation <= count && length < max_length; i += decimation)
+    {
+        bool moving = false;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t frame = 0;
+            for (uint8_t j = 0; j < decimation; j++)
+                frame += samples[(i + j) * 3 + axis];
+            frame /= decimation;
+            if (i == 0)
+                rest[axis] = frame;
+
+            int32_t value = (frame - rest[axis]) >> shift;
+            values[length * 3 + axis] = value > 127 ? 127 : (value < -127 ? -127 : value);
+            moving |= value > 1 || value < -1;
+        }
+
+        //# leading rest is dropped, the template starts with the motion
+        if (length > 0 || moving)
+            length++;
+    }
+    return length;
+}
+
+/*!
+ *  @brief  Checking if the matcher is running
+ *  @return true if armed
+ */
+bool BMA400Gesture::IsArmed()
+{
+    return armed;
+}
+
+/*!
+ *  @brief  Getting the last recognized gesture
+ *  @return template index. -1 if none
+ */
+int8_t BMA400Gesture::GetLastGesture()
+{
+    return last_gesture;
+}
+
+/*!
+ *  @brief  Getting the distance of the last recognized gesture
+ *  @return mean distance per feature
+ */
+uint16_t BMA400Gesture::GetLastDistance()
+{
+    return last_distance;
+}
+
+/*!
+ *  @brief  Getting the number of features run through the matcher (its processing cost)
+ *  @return number of features
+ */
+uint32_t BMA400Gesture::GetMatchedFeatures()
+{
+    return matched_features;
+}
+
+//* Private methods
+uint8_t BMA400Gesture::step(const int8_t *feature)
+{
+    bool open = remaining > 0;
+    bool alive = false;
+    uint8_t recognized = 0;
+    matched_features++;
+
+    for (uint8_t i = 0; i < template_count; i++)
+    {
+        bool template_alive;
+        if (stepTemplate(i, feature, open, template_alive))
+            recognized++;
+        alive |= template_alive;
+    }
+
+    time++;
+    if (remaining > 0)
+        remaining--;
+    else if (!alive) //# hold time over and every running match abandoned or reported
+        armed = false;
+    return recognized;
+}
+
+bool BMA400Gesture::stepTemplate(uint8_t index, const int8_t *feature, bool open, bool &alive)
+{
+    gesture_template_t &gesture = templates[index];
+
+    //# new DTW column: a path may start at every feature (distance[0] = 0) while open
+    uint16_t diagonal = gesture.distance[0], diagonal_start = gesture.start[0];
+    gesture.distance[0] = open ? 0 : BMA400_GESTURE_ABANDONED;
+    gesture.start[0] = time;
+    for (uint8_t i = 1; i <= gesture.length; i++)
+    {
+        uint16_t best = gesture.distance[i - 1], best_start = gesture.start[i - 1];
+        if (gesture.distance[i] < best)
+        {
+            best = gesture.distance[i];
+            best_start = gesture.start[i];
+        }
+        if (diagonal < best)
+        {
+            best = diagonal;
+            best_start = diagonal_start;
+        }
+        diagonal = gesture.distance[i];
+        diagonal_start = gesture.start[i];
+
+        //# paths are limited to twice the template length, so every path ends
+        uint32_t cost = BMA400_GESTURE_ABANDONED;
+        if (best != BMA400_GESTURE_ABANDONED && (uint16_t)(time - best_start) < gesture.length * 2)
+        {
+            const int8_t *value = gesture.values + (i - 1) * 3;
+            cost = best;
+            for (uint8_t axis = 0; axis < 3; axis++)
+                cost += feature[axis] > value[axis] ? feature[axis] - value[axis] : value[axis] - feature[axis];
+            if (cost > gesture.bound) //# early abandoning, costs only grow along a path
+                cost = BMA400_GESTURE_ABANDONED;
+        }
+        gesture.distance[i] = cost;
+        gesture.start[i] = best_start;
+    }
+
+    //# the best match is reported once no running path overlapping it can beat it
+    bool reported = false;
+    if (gesture.best != BMA400_GESTURE_ABANDONED)
+    {
+        bool final = true;
+        for (uint8_t i = 1; i <= gesture.length && final; i++)
+            if (gesture.distance[i] < gesture.best && (int16_t)(gesture.start[i] - gesture.best_end) <= 0)
+                final = false;
+
+        if (final)
+        {
+            last_gesture = index;
+            last_distance = gesture.best / gesture.length;
+            uint16_t duration = (gesture.best_end - gesture.best_start + 1) * decimation;
+            for (uint8_t i = 1; i <= gesture.length; i++)
+                if ((int16_t)(gesture.start[i] - gesture.best_end) <= 0)
+                    gesture.distance[i] = BMA400_GESTURE_ABANDONED;
+            gesture.best = BMA400_GESTURE_ABANDONED;
+            reported = true;
+
+            if (callback != nullptr)
+                callback(index, last_distance, duration, context);
+        }
+    }
+
+    if (gesture.distance[gesture.length] < gesture.best)
+    {
+        gesture.best = gesture.distance[gesture.length];
+        gesture.best_start = gesture.start[gesture.length];
+        gesture.best_end = time;
+    }
+
+    alive = gesture.best != BMA400_GESTURE_ABANDONED;
+    for (uint8_t i = 1; i <= gesture.length && !alive; i++)
+        alive = gesture.distance[i] != BMA400_GESTURE_ABANDONED;
+    return reported;
+}
+
+void BMA400Gesture::resetColumns()
+{
+    for (uint8_t i = 0; i < template_count; i++)
+    {
+        gesture_template_t &gesture = templates[i];
+        for (uint8_t j = 0; j <= gesture.length; j++)
+            gesture.distance[j] = BMA400_GESTURE_ABANDONED;
+        gesture.best = BMA400_GESTURE_ABANDONED;
+    }
+}
+
+void BMA400Gesture::quantize(const int32_t *frame, int8_t *feature)
+{
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        int32_t value = (frame[axis] - baseline[axis]) >> shift;
+        feature[axis] = value > 127 ? 127 : (value < -127 ? -127 : value);
+    }
+}
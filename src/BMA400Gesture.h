@@ -0,0 +1,98 @@
+/*!
+ * @file BMA400Gesture.h
+ *
+ *  Gesture recognition (shake, flick, custom motions) over acceleration streams for the BMA400 library.
+ *
+ *  Gestures are matched against recorded templates with streaming subsequence DTW
+ *  (SPRING): every template keeps one DTW column, updated per sample, so gestures are
+ *  found inside the stream without buffering them and without knowing where they start.
+ *  Cells whose distance exceeds the template threshold are abandoned early, and a match may
+ *  take at most twice the template length.
+ *
+ *  Samples are decimated and quantized to int8 features: acceleration minus the resting
+ *  baseline (tracked while idle), shifted right by a configurable amount. Templates use the
+ *  same features; Record converts a raw recording of a gesture into a template.
+ *
+ *  The matcher only runs while armed: Trigger arms it on the configured interrupts (the
+ *  generic interrupt in activity mode, i.e. motion) for a hold time, afterwards running
+ *  matches are finished and it goes idle again. Call Trigger before passing the FIFO batch
+ *  read after the interrupt, so the start of the gesture (already in the FIFO) is matched.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#ifndef BMA400_GESTURE_TEMPLATES
+#define BMA400_GESTURE_TEMPLATES 4 // maximum number of templates
+#endif
+
+#ifndef BMA400_GESTURE_LENGTH
+#define BMA400_GESTURE_LENGTH 32 // maximum template length (features)
+#endif
+
+class BMA400Gesture
+{
+public:
+    typedef void (*gesture_callback_t)(uint8_t gesture, uint16_t distance, uint16_t duration, void *context);
+
+    void Begin(uint8_t decimation = 2, uint8_t shift = 4);
+    int8_t AddTemplate(const int8_t *values, uint8_t length, uint8_t threshold);
+    void ClearTemplates();
+    void ConfigureTrigger(uint16_t sources = BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1, uint16_t hold = 64);
+    void SetCallback(gesture_callback_t callback, void *context = nullptr);
+
+    bool Trigger(BMA400::interrupt_source_t interrupts);
+    void Arm();
+    uint8_t Update(const int16_t *samples, uint16_t count);
+    uint8_t Update(const BMA400::sample_block_t &block);
+    uint8_t Record(const int16_t *samples, uint16_t count, int8_t *values, uint8_t max_length);
+
+    bool IsArmed();
+    int8_t GetLastGesture();
+    uint16_t GetLastDistance();
+    uint32_t GetMatchedFeatures();
+
+private:
+    typedef struct // template and its DTW column
+    {
+        const int8_t *values;
+        uint8_t length;
+        uint16_t bound;                               // threshold * length
+        uint16_t distance[BMA400_GESTURE_LENGTH + 1]; // accumulated distance, 0xFFFF abandoned
+        uint16_t start[BMA400_GESTURE_LENGTH + 1];    // feature index the path started at
+        uint16_t best;                                // best complete match not reported yet
+        uint16_t best_start;
+        uint16_t best_end;
+    } gesture_template_t;
+
+    gesture_template_t templates[BMA400_GESTURE_TEMPLATES];
+    uint8_t template_count = 0;
+    uint8_t decimation = 2;
+    uint8_t shift = 4;
+
+    uint16_t trigger_sources = BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1;
+    uint16_t hold = 64;
+    uint16_t remaining = 0; // features left before new paths stop being started
+    bool armed = false;
+
+    int32_t sum[3] = {0};
+    uint8_t summed = 0;
+    int32_t baseline[3] = {0};
+    bool baseline_valid = false;
+    uint16_t time = 0;
+
+    int8_t last_gesture = -1;
+    uint16_t last_distance = 0;
+    uint32_t matched_features = 0;
+    gesture_callback_t callback = nullptr;
+    void *context = nullptr;
+
+    uint8_t step(const int8_t *feature);
+    bool stepTemplate(uint8_t index, const int8_t *feature, bool open, bool &alive);
+    void resetColumns();
+    void quantize(const int32_t *frame, int8_t *feature);
+};
@@ -0,0 +1,201 @@
+/*!
+ * @file BMA400Governor.cpp
+ *
+ *  Activity-driven power mode / data rate governor for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Governor.h>
+
+/*!
+ *  @brief  Starting the governor. The sensor is switched to the still profile immediately
+ *  @param  _sensor initialized BMA400 sensor
+ *  @param  still profile (power mode & data rate) used while there is no motion e.g. ULTRA_LOW_POWER 25Hz
+ *  @param  moving profile (power mode & data rate) used while moving e.g. NORMAL 200Hz
+ *  @param  _still_timeout time (ms) without any motion evidence before going back to the still profile
+ *  @param  _min_dwell minimum time (ms) spent in a state before leaving it again (prevents toggling)
+ */
+void BMA400Governor::Begin(BMA400 &_sensor,
+                           const governor_profile_t &still,
+                           const governor_profile_t &moving,
+                           uint32_t _still_timeout,
+                           uint32_t _min_dwell)
+{
+    sensor = &_sensor;
+    profiles[governor_state_t::STATE_STILL] = still;
+    profiles[governor_state_t::STATE_MOVING] = moving;
+    still_timeout = _still_timeout;
+    min_dwell = _min_dwell;
+
+    if (motion_mask == 0 && still_mask == 0)
+        ConfigureMotionSources();
+
+    uint32_t now = millis();
+    last_update = now;
+    ResetStatistics();
+    state = governor_state_t::STATE_MOVING; //# forces applying the still profile
+    enter(governor_state_t::STATE_STILL, now);
+    transitions = 0;
+}
+
+/*!
+ *  @brief  Selecting which decoded interrupts count as motion/stillness evidence
+ *  @param  motion_sources combination of interrupt_source_t flags treated as motion
+ *  @param  still_sources combination of interrupt_source_t flags treated as stillness (e.g. generic interrupt 2 in inactivity mode)
+ */
+void BMA400Governor::ConfigureMotionSources(uint16_t motion_sources, uint16_t still_sources)
+{
+    motion_mask = motion_sources;
+    still_mask = still_sources;
+}
+
+/*!
+ *  @brief  Setting the FIFO energy threshold used by Update(samples, count)
+ *  @param  threshold sum of the per axis variances of a batch (raw LSB^2) treated as motion. 0 disables the energy input
+ */
+void BMA400Governor::ConfigureEnergyThreshold(uint32_t threshold)
+{
+    energy_threshold = threshold;
+}
+
+/*!
+ *  @brief  Updating the governor without new evidence (applies the still timeout)
+ *  @return current state
+ */
+BMA400Governor::governor_state_t BMA400Governor::Update()
+{
+    return evaluate(false, false);
+}
+
+/*!
+ *  @brief  Updating the governor using decoded interrupts (see BMA400::GetInterrupts)
+ *  @param  interrupts interrupts read from the sensor
+ *  @return current state
+ */
+BMA400Governor::governor_state_t BMA400Governor::Update(BMA400::interrupt_source_t interrupts)
+{
+    return evaluate((interrupts & motion_mask) != 0, (interrupts & still_mask) != 0);
+}
+
+/*!
+ *  @brief  Updating the governor using the energy of a batch of raw samples (e.g. a FIFO drain)
+ *  @param  samples raw samples ordered as X Y Z X Y Z ...
+ *  @param  count number of samples (XYZ triplets)
+ *  @return current state
+ */
+BMA400Governor::governor_state_t BMA400Governor::Update(const int16_t *samples, uint16_t count)
+{
+    if (energy_threshold == 0 || count < 2)
+        return evaluate(false, false);
+
+    int32_t sum[3] = {0};
+    int64_t squares[3] = {0};
+    for (uint16_t i = 0; i < count; i++)
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t value = samples[i * 3 + axis];
+            sum[axis] += value;
+            squares[axis] += value * value;
+        }
+
+    uint64_t energy = 0;
+    for (uint8_t axis = 0; axis < 3; axis++)
+        energy += (uint64_t)(squares[axis] - (int64_t)sum[axis] * sum[axis] / count) / count;
+
+    return evaluate(energy >= energy_threshold, energy < energy_threshold / 2);
+}
+
+/*!
+ *  @brief  Getting the current state
+ *  @return current state
+ */
+BMA400Governor::governor_state_t BMA400Governor::GetState()
+{
+    return state;
+}
+
+/*!
+ *  @brief  Getting the total time spent in a state since Begin/ResetStatistics
+ *  @param  target state
+ *  @return time in ms
+ */
+uint32_t BMA400Governor::GetTimeInState(governor_state_t target)
+{
+    account(millis());
+    return time_in_state[target];
+}
+
+/*!
+ *  @brief  Getting the number of profile switches since Begin/ResetStatistics
+ *  @return number of transitions
+ */
+uint32_t BMA400Governor::GetTransitions()
+{
+    return transitions;
+}
+
+/*!
+ *  @brief  Clearing time in state and transition counters
+ */
+void BMA400Governor::ResetStatistics()
+{
+    last_update = millis();
+    time_in_state[governor_state_t::STATE_STILL] = 0;
+    time_in_state[governor_state_t::STATE_MOVING] = 0;
+    transitions = 0;
+}
+
+//* Private methods
+void BMA400Governor::account(uint32_t now)
+{
+    time_in_state[state] += now - last_update;
+    last_update = now;
+}
+
+void BMA400Governor::enter(governor_state_t target, uint32_t now)
+{
+    account(now);
+    if (target == state)
+        return;
+
+    state = target;
+    state_entered = now;
+    motion_pending = false;
+    transitions++;
+    if (sensor == nullptr)
+        return;
+
+    sensor->SetPowerMode(profiles[target].mode);
+    sensor->SetDataRate(profiles[target].rate);
+}
+
+BMA400Governor::governor_state_t BMA400Governor::evaluate(bool motion, bool still)
+{
+    uint32_t now = millis();
+    account(now);
+
+    if (motion)
+    {
+        last_motion = now;
+        motion_pending = true;
+    }
+
+    if (now - state_entered < min_dwell)
+        return state;
+
+    if (state == governor_state_t::STATE_STILL)
+    {
+        //# motion reported during the dwell time is acted on once it is over, unless it is already stale
+        if (motion_pending && now - last_motion < still_timeout)
+            enter(governor_state_t::STATE_MOVING, now);
+        else
+            motion_pending = false;
+    }
+    else if (!motion && (still || now - last_motion >= still_timeout))
+        enter(governor_state_t::STATE_STILL, now);
+
+    return state;
+}
@@ -0,0 +1,78 @@
+/*!
+ * @file BMA400Governor.h
+ *
+ *  Activity-driven power mode / data rate governor for the BMA400 library.
+ *
+ *  The governor moves the sensor between a "still" and a "moving" profile
+ *  (power mode + data rate) based on motion evidence fed to it by the application:
+ *  decoded interrupts (generic interrupts, activity change, step detector) or batches
+ *  of raw samples (FIFO energy). Hysteresis is applied in both directions and the time
+ *  spent in each state is accounted for.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+class BMA400Governor
+{
+public:
+    typedef enum // governor states
+    {
+        STATE_STILL,  // no motion, sensor is kept in the still profile
+        STATE_MOVING, // motion, sensor is kept in the moving profile
+    } governor_state_t;
+
+    typedef struct // sensor configuration applied in a state
+    {
+        BMA400::power_mode_t mode;
+        BMA400::output_data_rate_t rate;
+    } governor_profile_t;
+
+    void Begin(BMA400 &sensor,
+               const governor_profile_t &still,
+               const governor_profile_t &moving,
+               uint32_t still_timeout = 5000,
+               uint32_t min_dwell = 500);
+
+    void ConfigureMotionSources(
+        uint16_t motion_sources = BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_1 |
+                                  BMA400::interrupt_source_t::ADV_ACTIVITY_CHANGE |
+                                  BMA400::interrupt_source_t::ADV_STEP_DETECTOR_COUNTER,
+        uint16_t still_sources = BMA400::interrupt_source_t::ADV_GENERIC_INTERRUPT_2);
+    void ConfigureEnergyThreshold(uint32_t threshold);
+
+    governor_state_t Update();
+    governor_state_t Update(BMA400::interrupt_source_t interrupts);
+    governor_state_t Update(const int16_t *samples, uint16_t count);
+
+    governor_state_t GetState();
+    uint32_t GetTimeInState(governor_state_t state);
+    uint32_t GetTransitions();
+    void ResetStatistics();
+
+private:
+    BMA400 *sensor = nullptr;
+    governor_profile_t profiles[2];
+    governor_state_t state = governor_state_t::STATE_STILL;
+
+    uint16_t motion_mask = 0;
+    uint16_t still_mask = 0;
+    uint32_t energy_threshold = 0;
+
+    uint32_t still_timeout = 0;
+    uint32_t min_dwell = 0;
+    uint32_t last_motion = 0;
+    bool motion_pending = false; // motion since entering the current state
+    uint32_t state_entered = 0;
+    uint32_t last_update = 0;
+    uint32_t time_in_state[2] = {0};
+    uint32_t transitions = 0;
+
+    void account(uint32_t now);
+    void enter(governor_state_t target, uint32_t now);
+    governor_state_t evaluate(bool motion, bool still);
+};
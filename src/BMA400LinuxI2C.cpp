@@ -0,0 +1,180 @@
+/*!
+ * @file BMA400LinuxI2C.cpp
+ *
+ *  Linux userspace (i2c-dev) transport for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#if defined(__linux__) && !defined(ARDUINO)
+#include <BMA400LinuxI2C.h>
+
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BMA400_LINUX_MAX_WRITE BMA400_FIFO_SIZE // register address + data, covers GetMaxTransferSize
+
+BMA400LinuxI2C::~BMA400LinuxI2C()
+{
+    Close();
+}
+
+/*!
+ *  @brief  Opening an i2c-dev device
+ *  @param  device device path e.g. /dev/i2c-1
+ *  @return true if the device is opened
+ */
+bool BMA400LinuxI2C::Open(const char *device)
+{
+    Close();
+    fd = open(device, O_RDWR);
+    return fd >= 0;
+}
+
+/*!
+ *  @brief  Opening an i2c-dev device by bus number
+ *  @param  bus_number N of /dev/i2c-N
+ *  @return true if the device is opened
+ */
+bool BMA400LinuxI2C::Open(int bus_number)
+{
+    char device[20];
+    snprintf(device, sizeof(device), "/dev/i2c-%d", bus_number);
+    return Open(device);
+}
+
+/*!
+ *  @brief  Closing the device
+ */
+void BMA400LinuxI2C::Close()
+{
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+}
+
+/*!
+ *  @brief  Checking if the device is opened
+ *  @return true if the device is opened
+ */
+bool BMA400LinuxI2C::IsOpen()
+{
+    return fd >= 0;
+}
+
+/*!
+ *  @brief  Replacing the ioctl call, e.g. with a simulated device for testing
+ *  @param  _handler function called instead of ioctl(). nullptr restores ioctl()
+ */
+void BMA400LinuxI2C::SetIoctlHandler(ioctl_handler_t _handler)
+{
+    handler = _handler;
+}
+
+/*!
+ *  @brief  Reading consecutive registers in one combined transfer (write address, repeated start, read)
+ *  @param  address sensor address
+ *  @param  _register first register
+ *  @param  values receives the register values
+ *  @param  length number of bytes to read
+ *  @return true if the transfer succeeded
+ */
+bool BMA400LinuxI2C::ReadRegisters(uint8_t address, uint8_t _register, uint8_t *values, uint16_t length)
+{
+    struct i2c_msg messages[2];
+
+    messages[0].addr = address;
+    messages[0].flags = 0;
+    messages[0].len = 1;
+    messages[0].buf = &_register;
+
+    messages[1].addr = address;
+    messages[1].flags = I2C_M_RD;
+    messages[1].len = length;
+    messages[1].buf = values;
+
+    return transfer(messages, 2) == 2;
+}
+
+/*!
+ *  @brief  Writing consecutive registers in one transfer
+ *  @param  address sensor address
+ *  @param  _register first register
+ *  @param  values register values
+ *  @param  length number of bytes to write (up to GetMaxTransferSize - 1)
+ *  @return true if the transfer succeeded
+ */
+bool BMA400LinuxI2C::WriteRegisters(uint8_t address, uint8_t _register, const uint8_t *values, uint16_t length)
+{
+    if (length >= BMA400_LINUX_MAX_WRITE)
+        return false; //# BMA400::write splits longer writes (see GetMaxTransferSize)
+
+    uint8_t data[BMA400_LINUX_MAX_WRITE];
+    data[0] = _register;
+    memcpy(data + 1, values, length);
+
+    struct i2c_msg message;
+    message.addr = address;
+    message.flags = 0;
+    message.len = length + 1;
+    message.buf = data;
+
+    return transfer(&message, 1) == 1;
+}
+
+/*!
+ *  @brief  Getting the largest transfer supported by i2c-dev (the write buffer holds the register address and the data)
+ *  @return maximum transaction size in bytes
+ */
+uint16_t BMA400LinuxI2C::GetMaxTransferSize()
+{
+    return BMA400_LINUX_MAX_WRITE;
+}
+
+//* Private methods
+int BMA400LinuxI2C::transfer(void *messages, uint32_t count)
+{
+    struct i2c_rdwr_ioctl_data data;
+    data.msgs = (struct i2c_msg *)messages;
+    data.nmsgs = count;
+
+    if (handler != nullptr)
+        return handler(fd, I2C_RDWR, &data);
+
+    if (fd < 0)
+        return -1;
+    return ioctl(fd, I2C_RDWR, &data);
+}
+
+//* Arduino timing functions used by the library
+unsigned long millis()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+unsigned long micros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)(now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    usleep(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    usleep(us);
+}
+#endif
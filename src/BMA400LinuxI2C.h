@@ -0,0 +1,46 @@
+/*!
+ * @file BMA400LinuxI2C.h
+ *
+ *  Linux userspace (i2c-dev) transport for the BMA400 library.
+ *
+ *  Register reads are sent as a single I2C_RDWR ioctl (register address write + read
+ *  with a repeated start), so every read costs one syscall and no STOP/START between
+ *  the address and the data phase. Long reads such as FIFO drains go out as one burst.
+ *
+ *  The ioctl call can be replaced (SetIoctlHandler) to run the driver against a
+ *  simulated device without any I2C hardware.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#if defined(__linux__) && !defined(ARDUINO)
+#include <BMA400.h>
+
+class BMA400LinuxI2C : public BMA400Interface
+{
+public:
+    typedef int (*ioctl_handler_t)(int fd, unsigned long request, void *arg);
+
+    ~BMA400LinuxI2C();
+
+    bool Open(const char *device);
+    bool Open(int bus_number);
+    void Close();
+    bool IsOpen();
+
+    void SetIoctlHandler(ioctl_handler_t handler);
+
+    bool ReadRegisters(uint8_t address, uint8_t _register, uint8_t *values, uint16_t length) override;
+    bool WriteRegisters(uint8_t address, uint8_t _register, const uint8_t *values, uint16_t length) override;
+    uint16_t GetMaxTransferSize() override;
+
+private:
+    int fd = -1;
+    ioctl_handler_t handler = nullptr;
+
+    int transfer(void *messages, uint32_t count);
+};
+#endif
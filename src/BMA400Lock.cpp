@@ -0,0 +1,117 @@
+/*!
+ * @file BMA400Lock.cpp
+ *
+ *  Locks for sharing the bus between tasks (see BMA400::SetLock).
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Lock.h>
+
+#if !defined(BMA400_HAS_FREERTOS) && defined(BMA400_HAS_STD_MUTEX)
+#include <functional>
+#include <thread>
+#endif
+
+#if defined(BMA400_HAS_STD_MUTEX)
+/*!
+ *  @brief  Taking the lock, blocks while another thread holds it
+ */
+void BMA400MutexLock::Lock()
+{
+    mutex.lock();
+}
+
+/*!
+ *  @brief  Releasing the lock
+ */
+void BMA400MutexLock::Unlock()
+{
+    mutex.unlock();
+}
+#endif
+
+#if defined(BMA400_HAS_FREERTOS)
+BMA400FreeRTOSLock::BMA400FreeRTOSLock()
+{
+    mutex = xSemaphoreCreateRecursiveMutex();
+}
+
+BMA400FreeRTOSLock::~BMA400FreeRTOSLock()
+{
+    vSemaphoreDelete(mutex);
+}
+
+/*!
+ *  @brief  Taking the lock, the task is blocked while another task holds it
+ */
+void BMA400FreeRTOSLock::Lock()
+{
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+}
+
+/*!
+ *  @brief  Releasing the lock
+ */
+void BMA400FreeRTOSLock::Unlock()
+{
+    xSemaphoreGiveRecursive(mutex);
+}
+#endif
+
+#if !defined(ARDUINO_ARCH_AVR)
+/*!
+ *  @brief  Taking the lock, spins (yielding) while another task holds it
+ */
+void BMA400SpinLock::Lock()
+{
+    uintptr_t self = currentOwner();
+    if (__atomic_load_n(&owner, __ATOMIC_RELAXED) == self)
+    {
+        depth++; //# only the owner itself can see its own id here
+        return;
+    }
+
+    uintptr_t expected = 0;
+    while (!__atomic_compare_exchange_n(&owner, &expected, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        expected = 0;
+        pause();
+    }
+    depth = 1;
+}
+
+/*!
+ *  @brief  Releasing the lock
+ */
+void BMA400SpinLock::Unlock()
+{
+    if (--depth == 0)
+        __atomic_store_n(&owner, (uintptr_t)0, __ATOMIC_RELEASE);
+}
+
+//* Private methods
+uintptr_t BMA400SpinLock::currentOwner()
+{
+#if defined(BMA400_HAS_FREERTOS)
+    return (uintptr_t)xTaskGetCurrentTaskHandle();
+#elif defined(BMA400_HAS_STD_MUTEX)
+    return std::hash<std::thread::id>()(std::this_thread::get_id()) | 1; //# never 0 (free)
+#else
+    return 1; //# single thread of execution
+#endif
+}
+
+void BMA400SpinLock::pause()
+{
+#if defined(BMA400_HAS_FREERTOS)
+    taskYIELD();
+#elif defined(BMA400_HAS_STD_MUTEX)
+    std::this_thread::yield();
+#elif defined(ARDUINO)
+    yield();
+#endif
+}
+#endif
@@ -0,0 +1,83 @@
+/*!
+ * @file BMA400Lock.h
+ *
+ *  Locks for sharing the bus between tasks (see BMA400::SetLock).
+ *
+ *  - BMA400MutexLock: std::recursive_mutex (host and ESP32)
+ *  - BMA400FreeRTOSLock: FreeRTOS recursive mutex, the waiting task is blocked
+ *  - BMA400SpinLock: busy waiting on an atomic owner, yields while waiting. Taking a free
+ *    lock is a single compare-and-swap
+ *
+ *  Masking interrupts (critical sections) is not offered: Wire itself needs interrupts to
+ *  complete a transaction. The driver must not be called from an interrupt handler.
+ *
+ *  The same lock object has to be given to every driver (and any other code) using the bus.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+//# bare-metal toolchains ship <mutex> without std::recursive_mutex, define BMA400_HAS_STD_MUTEX to force it
+#if !defined(BMA400_HAS_STD_MUTEX) && (!defined(ARDUINO) || defined(ESP_PLATFORM))
+#define BMA400_HAS_STD_MUTEX
+#endif
+
+#if !defined(BMA400_HAS_FREERTOS) && (defined(ESP_PLATFORM) || defined(BMA400_USE_FREERTOS))
+#define BMA400_HAS_FREERTOS
+#endif
+
+#if defined(BMA400_HAS_STD_MUTEX)
+#include <mutex>
+
+class BMA400MutexLock : public BMA400Lock
+{
+public:
+    void Lock() override;
+    void Unlock() override;
+
+private:
+    std::recursive_mutex mutex;
+};
+#endif
+
+#if defined(BMA400_HAS_FREERTOS)
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <FreeRTOS.h>
+#include <semphr.h>
+#endif
+
+class BMA400FreeRTOSLock : public BMA400Lock
+{
+public:
+    BMA400FreeRTOSLock();
+    ~BMA400FreeRTOSLock();
+    void Lock() override;
+    void Unlock() override;
+
+private:
+    SemaphoreHandle_t mutex;
+};
+#endif
+
+#if !defined(ARDUINO_ARCH_AVR)
+class BMA400SpinLock : public BMA400Lock
+{
+public:
+    void Lock() override;
+    void Unlock() override;
+
+private:
+    uintptr_t owner = 0; // 0 = free
+    uint16_t depth = 0;
+
+    static uintptr_t currentOwner();
+    static void pause();
+};
+#endif
@@ -0,0 +1,245 @@
+/*!
+ * @file BMA400Mux.cpp
+ *
+ *  I2C multiplexer (TCA9548A and compatible) support for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Mux.h>
+
+#if defined(ARDUINO)
+/*!
+ *  @brief  Starting the mux on a TwoWire bus. No channel is assumed to be selected
+ *  @param  _wire TwoWire interface - defalt Wire
+ *  @param  _address mux address (0x70 - 0x77)
+ */
+void BMA400Mux::Begin(TwoWire &_wire, uint8_t _address)
+{
+    wire = &_wire;
+    bus = nullptr;
+    address = _address;
+    Invalidate();
+}
+#endif
+
+/*!
+ *  @brief  Starting the mux on a custom transport. No channel is assumed to be selected
+ *  @param  _bus transport implementing BMA400Interface (e.g. BMA400LinuxI2C or a simulated bus)
+ *  @param  _address mux address (0x70 - 0x77)
+ */
+void BMA400Mux::Begin(BMA400Interface &_bus, uint8_t _address)
+{
+    bus = &_bus;
+    address = _address;
+    Invalidate();
+}
+
+/*!
+ *  @brief  Selecting a channel. Nothing is written if the channel is already selected
+ *  @param  _channel channel (0 - 7)
+ *  @return false if the mux did not acknowledge or the channel is invalid
+ */
+bool BMA400Mux::Select(uint8_t _channel)
+{
+    if (_channel >= BMA400_MUX_CHANNELS)
+        return false;
+
+    if (_channel == channel)
+    {
+        skipped++;
+        return true;
+    }
+
+    selects++;
+    if (!writeControl(1 << _channel))
+    {
+        channel = BMA400_MUX_NONE;
+        return false;
+    }
+    channel = _channel;
+    return true;
+}
+
+/*!
+ *  @brief  Disconnecting all channels
+ *  @return false if the mux did not acknowledge
+ */
+bool BMA400Mux::Deselect()
+{
+    channel = BMA400_MUX_NONE;
+    return writeControl(0x00);
+}
+
+/*!
+ *  @brief  Getting the selected channel
+ *  @return channel or BMA400_MUX_NONE if unknown
+ */
+uint8_t BMA400Mux::GetChannel()
+{
+    return channel;
+}
+
+/*!
+ *  @brief  Forgetting the selected channel, the next Select is written. Call it when something else
+ *          changed the mux (or after a reset). Failed sensor transactions do it automatically
+ */
+void BMA400Mux::Invalidate()
+{
+    channel = BMA400_MUX_NONE;
+}
+
+/*!
+ *  @brief  Getting the number of selects written to the mux since Begin/ResetStatistics
+ *  @return number of selects
+ */
+uint32_t BMA400Mux::GetSelects()
+{
+    return selects;
+}
+
+/*!
+ *  @brief  Getting the number of selects skipped because the channel was already selected
+ *  @return number of skipped selects
+ */
+uint32_t BMA400Mux::GetSkippedSelects()
+{
+    return skipped;
+}
+
+/*!
+ *  @brief  Clearing the select counters
+ */
+void BMA400Mux::ResetStatistics()
+{
+    selects = 0;
+    skipped = 0;
+}
+
+//* Private methods
+bool BMA400Mux::writeControl(uint8_t value)
+{
+    if (bus != nullptr)
+    {
+        uint8_t none = 0;
+        return bus->WriteRegisters(address, value, &none, 0); //# the control byte alone, without data
+    }
+
+#if defined(ARDUINO)
+    if (wire == nullptr)
+        return false;
+
+    wire->beginTransmission(address);
+    wire->write(value);
+    return wire->endTransmission() == 0;
+#else
+    return false;
+#endif
+}
+
+/*!
+ *  @brief  Starting the poller
+ *  @param  _mux mux the sensors are connected to
+ */
+void BMA400MuxPoller::Begin(BMA400Mux &_mux)
+{
+    mux = &_mux;
+    count = 0;
+}
+
+/*!
+ *  @brief  Adding a sensor initialized with a mux channel. Sensors keep their index (order of adding)
+ *  @param  sensor initialized sensor
+ *  @return false if the poller is full
+ */
+bool BMA400MuxPoller::Add(BMA400 &sensor)
+{
+    if (count >= BMA400_POLLER_SIZE)
+        return false;
+
+    sensors[count] = &sensor;
+
+    //# keeping the order sorted by channel (stable, sensors on one channel stay in adding order)
+    uint8_t channel = sensor.GetMuxChannel();
+    uint8_t i = count;
+    for (; i > 0 && sensors[order[i - 1]]->GetMuxChannel() > channel; i--)
+        order[i] = order[i - 1];
+    order[i] = count;
+    count++;
+    return true;
+}
+
+/*!
+ *  @brief  Getting the number of sensors
+ *  @return number of sensors
+ */
+uint8_t BMA400MuxPoller::GetCount()
+{
+    return count;
+}
+
+/*!
+ *  @brief  Calling a function for every sensor, ordered to minimise channel switches
+ *  @param  callback called with the sensor, its index and the context
+ *  @param  context passed to the callback
+ */
+void BMA400MuxPoller::ForEach(poll_callback_t callback, void *context)
+{
+    uint8_t start = first();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t index = order[(start + i) % count];
+        callback(*sensors[index], index, context);
+    }
+}
+
+/*!
+ *  @brief  Reading the acceleration of all sensors (raw values, see BMA400::ReadAcceleration)
+ *  @param  values receives X Y Z per sensor by index (3 x GetCount values)
+ *  @return number of sensors read without bus error
+ */
+uint8_t BMA400MuxPoller::ReadAcceleration(int16_t *values)
+{
+    uint8_t succeeded = 0;
+    uint8_t start = first();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t index = order[(start + i) % count];
+        sensors[index]->ReadAcceleration(values + index * 3);
+        if (sensors[index]->GetLastBusStatus() == BMA400::bus_status_t::BUS_OK)
+            succeeded++;
+    }
+    return succeeded;
+}
+
+/*!
+ *  @brief  Reading the interrupts of all sensors (see BMA400::GetInterrupts)
+ *  @param  interrupts receives the interrupts per sensor by index (GetCount values)
+ *  @return number of sensors read without bus error
+ */
+uint8_t BMA400MuxPoller::GetInterrupts(BMA400::interrupt_source_t *interrupts)
+{
+    uint8_t succeeded = 0;
+    uint8_t start = first();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t index = order[(start + i) % count];
+        interrupts[index] = sensors[index]->GetInterrupts();
+        if (sensors[index]->GetLastBusStatus() == BMA400::bus_status_t::BUS_OK)
+            succeeded++;
+    }
+    return succeeded;
+}
+
+//* Private methods
+uint8_t BMA400MuxPoller::first()
+{
+    //# starting at the selected channel saves one select per sweep
+    uint8_t channel = mux != nullptr ? mux->GetChannel() : BMA400_MUX_NONE;
+    for (uint8_t i = 0; i < count; i++)
+        if (sensors[order[i]]->GetMuxChannel() >= channel)
+            return sensors[order[i]]->GetMuxChannel() == BMA400_MUX_NONE ? 0 : i;
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*!
+ * @file BMA400Mux.h
+ *
+ *  I2C multiplexer (TCA9548A and compatible) support for the BMA400 library.
+ *
+ *  The BMA400 has only two addresses, larger arrays put the sensors behind 8 channel muxes.
+ *  A BMA400Mux object is shared by all sensors behind one mux (BMA400::Initialize with a
+ *  mux and a channel). It remembers the selected channel, so a select is only written
+ *  when the channel actually changes. The channel is selected inside the bus transaction,
+ *  so sensors used from several tasks must share one lock (see BMA400::SetLock).
+ *
+ *  BMA400MuxPoller reads a set of sensors ordered by channel, starting at the channel
+ *  currently selected, so a sweep costs one select per channel in use.
+ *
+ *  The mux can be driven through any BMA400Interface, e.g. a simulated bus for testing.
+ *  With several muxes on one bus, channels of the other muxes must be deselected
+ *  (Deselect) before sensors with the same address are used.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#define BMA400_MUX_ADDRESS 0x70 // TCA9548A with A0..A2 low
+#define BMA400_MUX_CHANNELS 8
+#define BMA400_MUX_NONE 0xFF // no channel selected / unknown
+
+#ifndef BMA400_POLLER_SIZE
+#define BMA400_POLLER_SIZE 32 // maximum sensors of a poller
+#endif
+
+class BMA400Mux
+{
+public:
+#if defined(ARDUINO)
+    void Begin(TwoWire &wire = Wire, uint8_t address = BMA400_MUX_ADDRESS);
+#endif
+    void Begin(BMA400Interface &bus, uint8_t address = BMA400_MUX_ADDRESS);
+
+    bool Select(uint8_t channel);
+    bool Deselect();
+    uint8_t GetChannel();
+    void Invalidate();
+
+    uint32_t GetSelects();
+    uint32_t GetSkippedSelects();
+    void ResetStatistics();
+
+private:
+    friend class BMA400; // sensors behind the mux use its bus
+
+    uint8_t address = BMA400_MUX_ADDRESS;
+#if defined(ARDUINO)
+    TwoWire *wire = nullptr;
+#endif
+    BMA400Interface *bus = nullptr;
+    uint8_t channel = BMA400_MUX_NONE;
+    uint32_t selects = 0;
+    uint32_t skipped = 0;
+
+    bool writeControl(uint8_t value);
+};
+
+class BMA400MuxPoller
+{
+public:
+    typedef void (*poll_callback_t)(BMA400 &sensor, uint8_t index, void *context);
+
+    void Begin(BMA400Mux &mux);
+    bool Add(BMA400 &sensor);
+    uint8_t GetCount();
+
+    void ForEach(poll_callback_t callback, void *context = nullptr);
+    uint8_t ReadAcceleration(int16_t *values);
+    uint8_t GetInterrupts(BMA400::interrupt_source_t *interrupts);
+
+private:
+    BMA400Mux *mux = nullptr;
+    BMA400 *sensors[BMA400_POLLER_SIZE];
+    uint8_t order[BMA400_POLLER_SIZE]; // sensor indexes sorted by channel
+    uint8_t count = 0;
+
+    uint8_t first();
+};
@@ -0,0 +1,269 @@
+/*!
+ * @file BMA400Pedometer.cpp
+ *
+ *  Step pipeline (cadence, step intervals, walking/running, distance) for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Pedometer.h>
+
+#define BMA400_PEDOMETER_MIN_INTERVAL 0.25 // s, 240 steps/min
+#define BMA400_PEDOMETER_MAX_INTERVAL 2.0  // s, longer gaps start a new walk
+#define BMA400_PEDOMETER_MIN_PEAK 0.05     // g above the filtered baseline
+
+/*!
+ *  @brief  Starting the pedometer. The step counter must be enabled (ConfigureStepDetectorCounter)
+ *  @param  _sensor initialized BMA400 sensor
+ *  @param  _sample_rate rate (Hz) of the samples passed to Update. 0 uses the configured data rate
+ */
+void BMA400Pedometer::Begin(BMA400 &_sensor, float _sample_rate)
+{
+    sensor = &_sensor;
+    const BMA400::rate_descriptor_t &descriptor = sensor->GetRateDescriptor();
+    sample_rate = _sample_rate > 0 ? _sample_rate : descriptor.frequency;
+    lsb_per_g = descriptor.lsb_per_g;
+    Reset();
+}
+
+/*!
+ *  @brief  Setting the walking/running classification
+ *  @param  _running_cadence cadence (steps/min) from which the gait counts as running
+ *  @param  _still_timeout time (s) without steps after which the gait is still
+ */
+void BMA400Pedometer::ConfigureClassification(float _running_cadence, float _still_timeout)
+{
+    running_cadence = _running_cadence;
+    still_timeout = _still_timeout;
+}
+
+/*!
+ *  @brief  Setting the step lengths used for the distance
+ *  @param  walking step length (m) while walking
+ *  @param  running step length (m) while running
+ */
+void BMA400Pedometer::SetStepLength(float walking, float running)
+{
+    step_length[gait_t::GAIT_WALKING] = walking;
+    step_length[gait_t::GAIT_RUNNING] = running;
+}
+
+/*!
+ *  @brief  Processing one batch of samples (e.g. a FIFO drain) and reading the step counter once
+ *  @param  samples raw samples ordered as X Y Z X Y Z ...
+ *  @param  count number of samples (XYZ triplets)
+ *  @return true if steps were counted since the previous Update
+ */
+bool BMA400Pedometer::Update(const int16_t *samples, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        float x = samples[i * 3], y = samples[i * 3 + 1], z = samples[i * 3 + 2];
+        detectPeak(sqrt(x * x + y * y + z * z) / lsb_per_g);
+        time++;
+    }
+
+    uint32_t before = steps;
+    updateCounter();
+    return steps != before;
+}
+
+/*!
+ *  @brief  Processing the samples of a block and reading the step counter once
+ *  @param  block block filled by ReadFifo
+ *  @return true if steps were counted since the previous Update
+ */
+bool BMA400Pedometer::Update(const BMA400::sample_block_t &block)
+{
+    return Update(block.values, block.count);
+}
+
+/*!
+ *  @brief  Getting the number of steps since Begin/Reset (hardware counter, not limited to 24 bit)
+ *  @return number of steps
+ */
+uint32_t BMA400Pedometer::GetSteps()
+{
+    return steps;
+}
+
+/*!
+ *  @brief  Getting the cadence
+ *  @return steps per minute. 0 while still
+ */
+float BMA400Pedometer::GetCadence()
+{
+    if (isStill())
+        return 0;
+
+    float interval = GetStepInterval();
+    return interval > 0 ? 60 / interval : getHardwareCadence();
+}
+
+/*!
+ *  @brief  Getting the mean interval between the recent steps found in the samples
+ *  @return interval in s. 0 if there are too few steps
+ */
+float BMA400Pedometer::GetStepInterval()
+{
+    if (interval_count < 2)
+        return 0;
+
+    float sum = 0;
+    for (uint8_t i = 0; i < interval_count; i++)
+        sum += intervals[i];
+    return sum / interval_count;
+}
+
+/*!
+ *  @brief  Getting the gait class from the cadence
+ *  @return still, walking or running
+ */
+BMA400Pedometer::gait_t BMA400Pedometer::GetGait()
+{
+    float cadence = GetCadence();
+    if (cadence <= 0)
+        return gait_t::GAIT_STILL;
+    return cadence >= running_cadence ? gait_t::GAIT_RUNNING : gait_t::GAIT_WALKING;
+}
+
+/*!
+ *  @brief  Getting the distance: steps times the step length of the gait they were made in (see SetStepLength)
+ *  @return distance in m
+ */
+float BMA400Pedometer::GetDistance()
+{
+    return distance;
+}
+
+/*!
+ *  @brief  Clearing steps, distance and the cadence history. The hardware counter is not reset
+ */
+void BMA400Pedometer::Reset()
+{
+    counter_valid = false;
+    steps = 0;
+    distance = 0;
+    batch_head = 0;
+    batch_count = 0;
+    time = 0;
+    filter_valid = false;
+    gravity = 0;
+    smooth = 0;
+    previous = 0;
+    rising = false;
+    peak_level = 0.1;
+    peak_valid = false;
+    interval_head = 0;
+    interval_count = 0;
+    step_valid = false;
+}
+
+//* Private methods
+void BMA400Pedometer::updateCounter()
+{
+    uint8_t values[3];
+    if (sensor == nullptr || sensor->ReadRegisters(BMA400_REG_STEP_CNT0, values, 3) != BMA400::bus_status_t::BUS_OK)
+        return;
+
+    uint32_t value = values[0] + values[1] * 256 + (uint32_t)values[2] * 256 * 256;
+    uint32_t delta = (value - counter) & 0xFFFFFF; //# 24 bit wrap
+    if (!counter_valid)
+        delta = 0;
+    else if (delta >= 0x800000) //# counter was reset (ResetStepCounter)
+        delta = value;
+    counter = value;
+    counter_valid = true;
+
+    if (delta > 0)
+    {
+        steps += delta;
+        if (isStill())
+        {
+            last_step = time; //# steps without peaks in the samples still count as moving
+            step_valid = true;
+        }
+        gait_t gait = GetGait();
+        distance += delta * step_length[gait == gait_t::GAIT_STILL ? gait_t::GAIT_WALKING : gait];
+    }
+
+    batch_time[batch_head] = time;
+    batch_steps[batch_head] = steps;
+    batch_head = (batch_head + 1) % BMA400_PEDOMETER_BATCHES;
+    if (batch_count < BMA400_PEDOMETER_BATCHES)
+        batch_count++;
+}
+
+void BMA400Pedometer::detectPeak(float magnitude)
+{
+    //# gravity removed by a slow baseline (~0.5 Hz), steps smoothed by a ~4 Hz low pass
+    if (!filter_valid)
+    {
+        gravity = magnitude;
+        filter_valid = true;
+    }
+    gravity += (magnitude - gravity) * (3.1f / sample_rate);
+    smooth += (magnitude - gravity - smooth) * (25.0f / (sample_rate + 25.0f));
+
+    bool was_rising = rising;
+    rising = smooth > previous;
+    float value = previous;
+    previous = smooth;
+
+    if (!was_rising || rising) //# not a local maximum
+        return;
+
+    float threshold = peak_level / 2;
+    if (threshold < BMA400_PEDOMETER_MIN_PEAK)
+        threshold = BMA400_PEDOMETER_MIN_PEAK;
+    if (value < threshold)
+        return;
+
+    float interval = getElapsed(last_peak);
+    if (peak_valid && interval < BMA400_PEDOMETER_MIN_INTERVAL)
+        return;
+
+    peak_level += (value - peak_level) / 4;
+    if (peak_valid && interval <= BMA400_PEDOMETER_MAX_INTERVAL)
+    {
+        intervals[interval_head] = interval;
+        interval_head = (interval_head + 1) % BMA400_PEDOMETER_INTERVALS;
+        if (interval_count < BMA400_PEDOMETER_INTERVALS)
+            interval_count++;
+    }
+    else
+    {
+        interval_head = 0; //# a new walk, old intervals do not describe it
+        interval_count = 0;
+    }
+
+    last_peak = time;
+    last_step = time;
+    peak_valid = true;
+    step_valid = true;
+}
+
+float BMA400Pedometer::getHardwareCadence()
+{
+    if (batch_count < 2)
+        return 0;
+
+    uint8_t last = (batch_head + BMA400_PEDOMETER_BATCHES - 1) % BMA400_PEDOMETER_BATCHES;
+    uint8_t first = (batch_head + BMA400_PEDOMETER_BATCHES - batch_count) % BMA400_PEDOMETER_BATCHES;
+    float duration = (uint32_t)(batch_time[last] - batch_time[first]) / sample_rate;
+    if (duration <= 0)
+        return 0;
+    return (batch_steps[last] - batch_steps[first]) * 60 / duration;
+}
+
+float BMA400Pedometer::getElapsed(uint32_t since)
+{
+    return (uint32_t)(time - since) / sample_rate;
+}
+
+bool BMA400Pedometer::isStill()
+{
+    return !step_valid || getElapsed(last_step) > still_timeout;
+}
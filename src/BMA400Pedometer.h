@@ -0,0 +1,91 @@
+/*!
+ * @file BMA400Pedometer.h
+ *
+ *  Step pipeline (cadence, step intervals, walking/running, distance) for the BMA400 library.
+ *
+ *  The on-chip step counter is the authority for the number of steps. It is read once per
+ *  FIFO batch (Update) and extended to 32 bit, handling the 24 bit wrap and counter resets.
+ *  The FIFO samples of the batch give the timing: steps are located as peaks of the
+ *  filtered acceleration magnitude, and the intervals between them give the cadence.
+ *  When there are not enough peaks (e.g. a short batch) the cadence falls back to the
+ *  hardware step count over the last batches.
+ *
+ *  Walking/running is told apart by cadence. The threshold and the step lengths used
+ *  for the distance are user settings: they depend on the person and where the sensor is
+ *  worn, so no defaults are assumed for the step lengths (distance stays 0 until set).
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#define BMA400_PEDOMETER_INTERVALS 8 // step intervals used for the cadence
+#define BMA400_PEDOMETER_BATCHES 8   // batches used for the hardware cadence
+
+class BMA400Pedometer
+{
+public:
+    typedef enum // gait classes
+    {
+        GAIT_STILL,   // no step within the still timeout
+        GAIT_WALKING, // cadence below the running cadence
+        GAIT_RUNNING, // cadence at or above the running cadence
+    } gait_t;
+
+    void Begin(BMA400 &sensor, float sample_rate = 0);
+    void ConfigureClassification(float running_cadence = 140, float still_timeout = 2);
+    void SetStepLength(float walking, float running);
+
+    bool Update(const int16_t *samples, uint16_t count);
+    bool Update(const BMA400::sample_block_t &block);
+
+    uint32_t GetSteps();
+    float GetCadence();
+    float GetStepInterval();
+    gait_t GetGait();
+    float GetDistance();
+    void Reset();
+
+private:
+    BMA400 *sensor = nullptr;
+    float sample_rate = 100;
+    float lsb_per_g = 1024;
+    float running_cadence = 140;
+    float still_timeout = 2;
+    float step_length[3] = {0, 0, 0};
+
+    //# hardware counter
+    bool counter_valid = false;
+    uint32_t counter = 0;
+    uint32_t steps = 0;
+    float distance = 0;
+    uint32_t batch_time[BMA400_PEDOMETER_BATCHES];
+    uint32_t batch_steps[BMA400_PEDOMETER_BATCHES];
+    uint8_t batch_head = 0;
+    uint8_t batch_count = 0;
+
+    //# peak detection on the FIFO samples
+    uint32_t time = 0; // samples processed (differences are wrap safe)
+    bool filter_valid = false;
+    float gravity = 0;
+    float smooth = 0;
+    float previous = 0;
+    bool rising = false;
+    float peak_level = 0.1; // running average of peak amplitudes (g)
+    uint32_t last_peak = 0;
+    bool peak_valid = false;
+    float intervals[BMA400_PEDOMETER_INTERVALS];
+    uint8_t interval_head = 0;
+    uint8_t interval_count = 0;
+    uint32_t last_step = 0; // time of the last step (peak or counter)
+    bool step_valid = false;
+
+    void updateCounter();
+    void detectPeak(float magnitude);
+    float getHardwareCadence();
+    float getElapsed(uint32_t since);
+    bool isStill();
+};
@@ -0,0 +1,308 @@
+/*!
+ * @file BMA400Scheduler.cpp
+ *
+ *  Read scheduler coalescing register reads of several clients for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Scheduler.h>
+
+/*!
+ *  @brief  Starting the scheduler
+ *  @param  _sensor initialized BMA400 sensor
+ *  @param  _window time (us) requests are collected before Update executes them. 0 = every Update call
+ *  @param  _gap number of unrequested registers a burst may read to merge two ranges (never clear-on-read ones)
+ */
+void BMA400Scheduler::Begin(BMA400 &_sensor, uint32_t _window, uint8_t _gap)
+{
+    sensor = &_sensor;
+    window = _window;
+    gap = _gap;
+    count = 0;
+    ResetStatistics();
+}
+
+/*!
+ *  @brief  Submitting a register read. The bytes are written when the window is executed (Update/Flush)
+ *  @param  _register first register
+ *  @param  values receives the register values. must stay valid until the callback
+ *  @param  length number of bytes to read
+ *  @param  callback called once the read is done. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the request is invalid (no sensor or length 0)
+ */
+bool BMA400Scheduler::Request(uint8_t _register, uint8_t *values, uint8_t length, BMA400::operation_callback_t callback, void *context)
+{
+    request_t *request = add(request_type_t::REQUEST_RAW, _register, length, callback, context);
+    if (request == nullptr)
+        return false;
+    request->values = values;
+    return true;
+}
+
+/*!
+ *  @brief  Submitting an acceleration read (raw values as BMA400::ReadAcceleration)
+ *  @param  values receives X Y Z. must stay valid until the callback
+ *  @param  callback called once the read is done. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the request is invalid
+ */
+bool BMA400Scheduler::RequestAcceleration(int16_t *values, BMA400::operation_callback_t callback, void *context)
+{
+    request_t *request = add(request_type_t::REQUEST_ACCELERATION, BMA400_REG_ACC_DATA, 6, callback, context);
+    if (request == nullptr)
+        return false;
+    request->destination = values;
+    return true;
+}
+
+/*!
+ *  @brief  Submitting an interrupt status read (as BMA400::GetInterrupts). Every client requesting
+ *          the interrupts in the same window gets the same (cleared on read) status
+ *  @param  interrupts receives the decoded interrupts. must stay valid until the callback
+ *  @param  callback called once the read is done. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the request is invalid
+ */
+bool BMA400Scheduler::RequestInterrupts(BMA400::interrupt_source_t *interrupts, BMA400::operation_callback_t callback, void *context)
+{
+    request_t *request = add(request_type_t::REQUEST_INTERRUPTS, BMA400_REG_INT_STAT_0, 3, callback, context);
+    if (request == nullptr)
+        return false;
+    request->destination = interrupts;
+    return true;
+}
+
+/*!
+ *  @brief  Submitting a step counter read (as BMA400::GetTotalSteps)
+ *  @param  steps receives the number of steps. must stay valid until the callback
+ *  @param  callback called once the read is done. can be nullptr
+ *  @param  context passed to the callback
+ *  @return false if the request is invalid
+ */
+bool BMA400Scheduler::RequestTotalSteps(uint32_t *steps, BMA400::operation_callback_t callback, void *context)
+{
+    request_t *request = add(request_type_t::REQUEST_STEPS, BMA400_REG_STEP_CNT0, 3, callback, context);
+    if (request == nullptr)
+        return false;
+    request->destination = steps;
+    return true;
+}
+
+/*!
+ *  @brief  Executing the pending requests once the window has passed. Call it from the main loop
+ *  @return true if requests were executed
+ */
+bool BMA400Scheduler::Update()
+{
+    if (count == 0 || micros() - window_start < window)
+        return false;
+
+    Flush();
+    return true;
+}
+
+/*!
+ *  @brief  Executing the pending requests now: sorted by register, merged into bursts and fanned out.
+ *          Callbacks are called after all reads are done and may submit requests for the next window
+ *  @return number of bus bursts used
+ */
+uint8_t BMA400Scheduler::Flush()
+{
+    uint8_t pending = count;
+    if (pending == 0)
+        return 0;
+
+    //# sorting by register (insertion sort, there are only a few requests)
+    for (uint8_t i = 0; i < pending; i++)
+    {
+        uint8_t j = i;
+        for (; j > 0 && requests[order[j - 1]]._register > requests[i]._register; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    uint16_t span = sensor->GetMaxTransferSize();
+    if (span > BMA400_SCHEDULER_SPAN)
+        span = BMA400_SCHEDULER_SPAN;
+
+    uint8_t buffer[BMA400_SCHEDULER_SPAN];
+    BMA400::bus_status_t status[BMA400_SCHEDULER_SIZE];
+    uint8_t bursts = 0;
+
+    for (uint8_t i = 0; i < pending;)
+    {
+        request_t &first = requests[order[i]];
+        if (!isMergeable(first, span))
+        {
+            status[order[i]] = sensor->ReadRegisters(first._register, first.values, first.length);
+            deliver(first, first.values, status[order[i]]);
+#if defined(BMA400_TELEMETRY)
+            recordInterrupts(first._register, first._register + first.length, first.values, status[order[i]]);
+#endif
+            bursts++;
+            i++;
+            continue;
+        }
+
+        uint16_t start = first._register;
+        uint16_t end = start + first.length;
+        uint8_t j = i + 1;
+        for (; j < pending; j++)
+        {
+            request_t &next = requests[order[j]];
+            uint16_t next_end = next._register + next.length;
+            if (!isMergeable(next, span) || next._register > end + gap)
+                break;
+            if (next._register > end && hasSideEffects(end, next._register - 1))
+                break;
+
+            uint16_t merged_end = next_end > end ? next_end : end;
+            if (merged_end - start > span)
+                break;
+            end = merged_end;
+        }
+
+        BMA400::bus_status_t result = sensor->ReadRegisters(start, buffer, end - start);
+        for (uint8_t k = i; k < j; k++)
+        {
+            status[order[k]] = result;
+            deliver(requests[order[k]], buffer + requests[order[k]]._register - start, result);
+        }
+#if defined(BMA400_TELEMETRY)
+        recordInterrupts(start, end, buffer, result);
+#endif
+        bursts++;
+        i = j;
+    }
+
+    //# the callbacks may submit new requests, which reuse the slots
+    BMA400::operation_callback_t callbacks[BMA400_SCHEDULER_SIZE];
+    void *contexts[BMA400_SCHEDULER_SIZE];
+    for (uint8_t i = 0; i < pending; i++)
+    {
+        callbacks[i] = requests[i].callback;
+        contexts[i] = requests[i].context;
+    }
+    count = 0;
+    total_transactions += bursts;
+
+    for (uint8_t i = 0; i < pending; i++)
+        if (callbacks[i] != nullptr)
+            callbacks[i](status[i], contexts[i]);
+
+    return bursts;
+}
+
+/*!
+ *  @brief  Getting the number of requests waiting for the window
+ *  @return number of pending requests
+ */
+uint8_t BMA400Scheduler::GetPendingRequests()
+{
+    return count;
+}
+
+/*!
+ *  @brief  Getting the number of requests served since Begin/ResetStatistics
+ *  @return number of requests
+ */
+uint32_t BMA400Scheduler::GetRequests()
+{
+    return total_requests;
+}
+
+/*!
+ *  @brief  Getting the number of bus bursts used since Begin/ResetStatistics (compare with GetRequests)
+ *  @return number of bursts
+ */
+uint32_t BMA400Scheduler::GetTransactions()
+{
+    return total_transactions;
+}
+
+/*!
+ *  @brief  Clearing the request and burst counters
+ */
+void BMA400Scheduler::ResetStatistics()
+{
+    total_requests = 0;
+    total_transactions = 0;
+}
+
+//* Private methods
+BMA400Scheduler::request_t *BMA400Scheduler::add(request_type_t type, uint8_t _register, uint8_t length, BMA400::operation_callback_t callback, void *context)
+{
+    if (sensor == nullptr || length == 0)
+        return nullptr;
+
+    if (count >= BMA400_SCHEDULER_SIZE) //# window is full, closing it early
+        Flush();
+
+    if (count == 0)
+        window_start = micros();
+
+    request_t *request = &requests[count++];
+    memset(request, 0, sizeof(request_t));
+    request->type = type;
+    request->_register = _register;
+    request->length = length;
+    request->values = request->data;
+    request->callback = callback;
+    request->context = context;
+    total_requests++;
+    return request;
+}
+
+#if defined(BMA400_TELEMETRY)
+void BMA400Scheduler::recordInterrupts(uint16_t start, uint16_t end, const uint8_t *bytes, BMA400::bus_status_t status)
+{
+    //# once per burst, every client of the window gets the same (cleared on read) status
+    if (status == BMA400::bus_status_t::BUS_OK && start <= BMA400_REG_INT_STAT_0 && end >= BMA400_REG_INT_STAT_0 + 3)
+        sensor->recordInterrupts(BMA400::decodeInterrupts(bytes + BMA400_REG_INT_STAT_0 - start));
+}
+#endif
+
+void BMA400Scheduler::deliver(request_t &request, const uint8_t *bytes, BMA400::bus_status_t status)
+{
+    if (request.values != bytes)
+        memcpy(request.values, bytes, request.length);
+
+    if (status != BMA400::bus_status_t::BUS_OK)
+        return;
+
+    switch (request.type)
+    {
+    case request_type_t::REQUEST_ACCELERATION:
+        BMA400::decodeAcceleration(request.data, (int16_t *)request.destination);
+        break;
+    case request_type_t::REQUEST_INTERRUPTS:
+        *(BMA400::interrupt_source_t *)request.destination = BMA400::decodeInterrupts(request.data);
+        break;
+    case request_type_t::REQUEST_STEPS:
+        *(uint32_t *)request.destination = request.data[0] + request.data[1] * 256 + (uint32_t)request.data[2] * 256 * 256;
+        break;
+    default:
+        break;
+    }
+}
+
+bool BMA400Scheduler::isMergeable(const request_t &request, uint16_t span)
+{
+    if (request.length > span)
+        return false;
+
+    //# FIFO_DATA pops a byte per read, it is read alone with exactly the requested length
+    uint16_t last = request._register + request.length - 1;
+    return request._register > BMA400_REG_FIFO_DATA || last < BMA400_REG_FIFO_DATA;
+}
+
+bool BMA400Scheduler::hasSideEffects(uint8_t first, uint8_t last)
+{
+    //# EVENT and INT_STAT0..2 are cleared on read, FIFO_DATA pops the FIFO
+    return (first <= BMA400_REG_INT_STAT_2 && last >= BMA400_REG_EVENT) ||
+           (first <= BMA400_REG_FIFO_DATA && last >= BMA400_REG_FIFO_DATA);
+}
@@ -0,0 +1,90 @@
+/*!
+ * @file BMA400Scheduler.h
+ *
+ *  Read scheduler coalescing register reads of several clients for the BMA400 library.
+ *
+ *  Clients (e.g. a step counter app, a tilt app and an interrupt handler) submit reads
+ *  instead of calling the driver directly. All reads submitted in the same window are
+ *  sorted by register, overlapping and adjacent ranges are merged into one burst and the
+ *  bytes are fanned out to every requester. Registers with read side effects are never
+ *  read on behalf of a request that did not ask for them:
+ *  - FIFO_DATA (reading pops the FIFO) is always read in its own transaction
+ *  - gaps between ranges are only bridged when they contain no clear-on-read register (EVENT, INT_STAT)
+ *
+ *  Writes are not scheduled, they go to the driver directly.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#ifndef BMA400_SCHEDULER_SIZE
+#define BMA400_SCHEDULER_SIZE 8 // maximum pending requests per window
+#endif
+
+#ifndef BMA400_SCHEDULER_SPAN
+#define BMA400_SCHEDULER_SPAN 32 // maximum length of a merged burst
+#endif
+
+class BMA400Scheduler
+{
+public:
+    void Begin(BMA400 &sensor, uint32_t window = 0, uint8_t gap = 0);
+
+    bool Request(uint8_t _register, uint8_t *values, uint8_t length, BMA400::operation_callback_t callback = nullptr, void *context = nullptr);
+    bool RequestAcceleration(int16_t *values, BMA400::operation_callback_t callback = nullptr, void *context = nullptr);
+    bool RequestInterrupts(BMA400::interrupt_source_t *interrupts, BMA400::operation_callback_t callback = nullptr, void *context = nullptr);
+    bool RequestTotalSteps(uint32_t *steps, BMA400::operation_callback_t callback = nullptr, void *context = nullptr);
+
+    bool Update();
+    uint8_t Flush();
+    uint8_t GetPendingRequests();
+
+    uint32_t GetRequests();
+    uint32_t GetTransactions();
+    void ResetStatistics();
+
+private:
+    typedef enum // how the bytes of a request are delivered
+    {
+        REQUEST_RAW,
+        REQUEST_ACCELERATION,
+        REQUEST_INTERRUPTS,
+        REQUEST_STEPS,
+    } request_type_t;
+
+    typedef struct
+    {
+        request_type_t type;
+        uint8_t _register;
+        uint8_t length;
+        uint8_t *values;
+        uint8_t data[6]; // raw bytes of decoded requests
+        void *destination;
+        BMA400::operation_callback_t callback;
+        void *context;
+    } request_t;
+
+    BMA400 *sensor = nullptr;
+    uint32_t window = 0;
+    uint8_t gap = 0;
+    uint32_t window_start = 0;
+
+    request_t requests[BMA400_SCHEDULER_SIZE];
+    uint8_t order[BMA400_SCHEDULER_SIZE];
+    uint8_t count = 0;
+
+    uint32_t total_requests = 0;
+    uint32_t total_transactions = 0;
+
+    request_t *add(request_type_t type, uint8_t _register, uint8_t length, BMA400::operation_callback_t callback, void *context);
+    void deliver(request_t &request, const uint8_t *bytes, BMA400::bus_status_t status);
+    static bool isMergeable(const request_t &request, uint16_t span);
+    static bool hasSideEffects(uint8_t first, uint8_t last);
+#if defined(BMA400_TELEMETRY)
+    void recordInterrupts(uint16_t start, uint16_t end, const uint8_t *bytes, BMA400::bus_status_t status);
+#endif
+};
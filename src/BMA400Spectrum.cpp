@@ -0,0 +1,405 @@
+/*!
+ * @file BMA400Spectrum.cpp
+ *
+ *  Vibration spectrum analysis on FIFO windows for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Spectrum.h>
+#include <BMA400Tilt.h>
+
+#define BMA400_SPECTRUM_PI 3.14159265358979f
+
+/*!
+ *  @brief  Setting up the analysis and tabulating the twiddle factors and the window function
+ *  @param  _size window length in samples, power of two from 8 to BMA400_SPECTRUM_SIZE
+ *  @param  _sample_rate rate (Hz) of the samples, e.g. GetRateDescriptor().frequency
+ *  @param  function window function
+ *  @param  _format float or fixed-point (Q15) FFT
+ *  @return false if the size is not supported
+ */
+bool BMA400Spectrum::Begin(uint16_t _size, float _sample_rate, window_t function, format_t _format)
+{
+    if (_size < 8 || _size > BMA400_SPECTRUM_SIZE || (_size & (_size - 1)) != 0)
+        return false;
+
+    size = _size;
+    sample_rate = _sample_rate;
+    format = _format;
+    stages = 0;
+    while ((2 << stages) < size)
+        stages++;
+
+    for (uint16_t k = 0; k <= size / 4; k++)
+    {
+        float value = sin(2 * BMA400_SPECTRUM_PI * k / size);
+        if (format == format_t::FORMAT_FIXED)
+            fixed_sine[k] = (int16_t)(value * 32767 + 0.5f);
+        else
+            sine[k] = value;
+    }
+
+    //# periodic window: w[n] = w[size - n], only 0..size/2 is stored
+    float sum = 0, squares = 0;
+    for (uint16_t n = 0; n <= size / 2; n++)
+    {
+        float x = 2 * BMA400_SPECTRUM_PI * n / size;
+        float value = 1;
+        switch (function)
+        {
+        case window_t::WINDOW_HANN:
+            value = 0.5f - 0.5f * cos(x);
+            break;
+
+        case window_t::WINDOW_HAMMING:
+            value = 0.54f - 0.46f * cos(x);
+            break;
+
+        case window_t::WINDOW_FLAT_TOP:
+            value = 0.21557895f - 0.41663158f * cos(x) + 0.277263158f * cos(2 * x) -
+                    0.083578947f * cos(3 * x) + 0.006947368f * cos(4 * x);
+            break;
+
+        default:
+            break;
+        }
+
+        if (format == format_t::FORMAT_FIXED)
+        {
+            fixed_window[n] = (int16_t)(value * 32767 + (value < 0 ? -0.5f : 0.5f));
+            value = fixed_window[n] / 32767.0f;
+        }
+        else
+            window[n] = value;
+
+        uint8_t copies = n == 0 || n == size / 2 ? 1 : 2;
+        sum += value * copies;
+        squares += value * value * copies;
+    }
+
+    //# sinusoid amplitude = 2 |X| / sum(w). the fixed FFT is scaled by 4 / (size / 2)
+    gain = 2 / sum;
+    fixed_gain = (uint16_t)(16 * 2 * (size / 2) / (4 * sum) * 256 + 0.5f);
+    noise_bandwidth = size * squares / (sum * sum);
+
+    bands = 0;
+    Reset();
+    return true;
+}
+
+/*!
+ *  @brief  Setting the frequency bands for GetBandEnergy
+ *  @param  edges band edges in Hz, bands + 1 ascending values. a bin belongs to a band if edge <= frequency < next edge
+ *  @param  _bands number of bands, up to BMA400_SPECTRUM_BANDS
+ *  @return false if too many bands or Begin was not called
+ */
+bool BMA400Spectrum::ConfigureBands(const float *edges, uint8_t _bands)
+{
+    if (_bands > BMA400_SPECTRUM_BANDS || size == 0 || sample_rate <= 0)
+        return false;
+
+    uint16_t bins = GetBinCount();
+    for (uint8_t i = 0; i <= _bands; i++)
+    {
+        float bin = ceil(edges[i] * size / sample_rate);
+        band_edges[i] = bin < 0 ? 0 : (bin > bins ? bins : (uint16_t)bin);
+    }
+    bands = _bands;
+    return true;
+}
+
+/*!
+ *  @brief  Setting the function called (from Add) after each analysed window
+ *  @param  _callback called with the spectrum, which can be read in the callback. nullptr disables it
+ *  @param  _context passed to the callback
+ */
+void BMA400Spectrum::SetCallback(spectrum_callback_t _callback, void *_context)
+{
+    callback = _callback;
+    context = _context;
+}
+
+/*!
+ *  @brief  Adding samples. A spectrum is computed whenever a window is full
+ *  @param  values raw samples ordered as X Y Z X Y Z ...
+ *  @param  count number of samples (XYZ triplets)
+ *  @return number of windows completed. without callback only the last one can be read
+ */
+uint16_t BMA400Spectrum::Add(const int16_t *values, uint16_t count)
+{
+    if (size == 0)
+        return 0;
+
+    uint16_t completed = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        for (uint8_t axis = 0; axis < 3; axis++)
+            samples[axis][fill] = values[i * 3 + axis];
+
+        if (++fill < size)
+            continue;
+
+        fill = 0;
+        process();
+        windows++;
+        completed++;
+        if (callback != nullptr)
+            callback(*this, context);
+    }
+    return completed;
+}
+
+/*!
+ *  @brief  Adding the samples of a block (e.g. from BMA400FifoStream)
+ *  @param  block block filled by ReadFifo
+ *  @return number of windows completed
+ */
+uint16_t BMA400Spectrum::Add(const BMA400::sample_block_t &block)
+{
+    return Add(block.values, block.count);
+}
+
+/*!
+ *  @brief  Dropping the samples of the incomplete window and clearing the spectra
+ */
+void BMA400Spectrum::Reset()
+{
+    fill = 0;
+    windows = 0;
+    memset(magnitudes, 0, sizeof(magnitudes));
+}
+
+/*!
+ *  @brief  Getting the number of bins of a spectrum: DC to Nyquist
+ *  @return size / 2 + 1
+ */
+uint16_t BMA400Spectrum::GetBinCount()
+{
+    return size / 2 + 1;
+}
+
+/*!
+ *  @brief  Getting the center frequency of a bin
+ *  @param  bin bin index
+ *  @return frequency in Hz
+ */
+float BMA400Spectrum::GetBinFrequency(uint16_t bin)
+{
+    return size == 0 ? 0 : bin * sample_rate / size;
+}
+
+/*!
+ *  @brief  Getting the amplitude spectrum of the last window (FORMAT_FLOAT)
+ *  @param  axis 0: X, 1: Y, 2: Z
+ *  @return GetBinCount amplitudes in raw LSB. nullptr in FORMAT_FIXED
+ */
+const float *BMA400Spectrum::GetMagnitudes(uint8_t axis)
+{
+    if (format != format_t::FORMAT_FLOAT || axis > 2)
+        return nullptr;
+    return magnitudes[axis];
+}
+
+/*!
+ *  @brief  Getting the amplitude spectrum of the last window (FORMAT_FIXED)
+ *  @param  axis 0: X, 1: Y, 2: Z
+ *  @return GetBinCount amplitudes in 1/16 raw LSB. nullptr in FORMAT_FLOAT
+ */
+const uint16_t *BMA400Spectrum::GetFixedMagnitudes(uint8_t axis)
+{
+    if (format != format_t::FORMAT_FIXED || axis > 2)
+        return nullptr;
+    return fixed_magnitudes[axis];
+}
+
+/*!
+ *  @brief  Getting the amplitude of one bin in either format
+ *  @param  axis 0: X, 1: Y, 2: Z
+ *  @param  bin bin index
+ *  @return amplitude in raw LSB
+ */
+float BMA400Spectrum::GetMagnitude(uint8_t axis, uint16_t bin)
+{
+    if (axis > 2 || bin >= GetBinCount())
+        return 0;
+    return format == format_t::FORMAT_FIXED ? fixed_magnitudes[axis][bin] / 16.0f : magnitudes[axis][bin];
+}
+
+/*!
+ *  @brief  Getting the energy of a band (see ConfigureBands) in the last window
+ *  @param  axis 0: X, 1: Y, 2: Z
+ *  @param  band band index
+ *  @return mean square in raw LSB^2 (its square root is the RMS of the band)
+ */
+float BMA400Spectrum::GetBandEnergy(uint8_t axis, uint8_t band)
+{
+    if (axis > 2 || band >= bands)
+        return 0;
+
+    float energy = 0;
+    for (uint16_t bin = band_edges[band]; bin < band_edges[band + 1]; bin++)
+    {
+        float amplitude = GetMagnitude(axis, bin);
+        energy += amplitude * amplitude / 2;
+    }
+    return energy / noise_bandwidth;
+}
+
+/*!
+ *  @brief  Getting the number of windows analysed since Begin/Reset
+ *  @return number of windows
+ */
+uint32_t BMA400Spectrum::GetWindows()
+{
+    return windows;
+}
+
+//* Private methods
+void BMA400Spectrum::process()
+{
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        if (format == format_t::FORMAT_FIXED)
+            transformFixed(axis);
+        else
+            transform(axis);
+    }
+}
+
+void BMA400Spectrum::transform(uint8_t axis)
+{
+    uint16_t half = size / 2;
+    int32_t sum = 0;
+    for (uint16_t n = 0; n < size; n++)
+        sum += samples[axis][n];
+    float mean = (float)sum / size;
+
+    //# even samples are the real, odd samples the imaginary parts of a half length complex FFT
+    for (uint16_t m = 0; m < half; m++)
+    {
+        uint16_t target = reverse(m) * 2;
+        uint16_t even = m * 2, odd = m * 2 + 1;
+        work[target] = (samples[axis][even] - mean) * window[even <= half ? even : size - even];
+        work[target + 1] = (samples[axis][odd] - mean) * window[odd <= half ? odd : size - odd];
+    }
+
+    for (uint8_t stage = 0; stage < stages; stage++)
+    {
+        uint16_t span = 1 << stage;
+        uint16_t step = half >> stage; //# W(2 span)^j = W(size)^(j step)
+        for (uint16_t j = 0; j < span; j++)
+        {
+            float wr = getCos(j * step), wi = -getSin(j * step);
+            for (uint16_t i = j; i < half; i += span * 2)
+            {
+                float *a = work + i * 2, *b = work + (i + span) * 2;
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    //# split: X[k] = E[k] - j W(size)^k O[k], E/O the spectra of the even/odd samples
+    for (uint16_t k = 0; k <= half; k++)
+    {
+        const float *z = work + (k % half) * 2, *c = work + ((half - k) % half) * 2;
+        float er = (z[0] + c[0]) / 2, ei = (z[1] - c[1]) / 2;
+        float or_ = (z[1] + c[1]) / 2, oi = (c[0] - z[0]) / 2;
+        float wr = getCos(k), ws = getSin(k);
+        float re = er + wr * or_ + ws * oi;
+        float im = ei + wr * oi - ws * or_;
+        float amplitude = sqrt(re * re + im * im) * gain;
+        magnitudes[axis][k] = k == 0 || k == half ? amplitude / 2 : amplitude;
+    }
+}
+
+void BMA400Spectrum::transformFixed(uint8_t axis)
+{
+    uint16_t half = size / 2;
+    int32_t sum = 0;
+    for (uint16_t n = 0; n < size; n++)
+        sum += samples[axis][n];
+    int32_t mean = (sum + (sum < 0 ? -(int32_t)half : half)) / size;
+
+    //# 12 bit samples scaled by 4 fit Q15 with headroom; each stage halves, so nothing overflows
+    for (uint16_t n = 0; n < size; n++)
+    {
+        uint16_t target = reverse(n / 2) * 2 + (n & 1);
+        int32_t value = samples[axis][n] - mean;
+        fixed_work[target] = (int16_t)((value * fixed_window[n <= half ? n : size - n]) >> 13);
+    }
+
+    for (uint8_t stage = 0; stage < stages; stage++)
+    {
+        uint16_t span = 1 << stage;
+        uint16_t step = half >> stage;
+        for (uint16_t j = 0; j < span; j++)
+        {
+            int32_t wr = getFixedCos(j * step), wi = -getFixedSin(j * step);
+            for (uint16_t i = j; i < half; i += span * 2)
+            {
+                int16_t *a = fixed_work + i * 2, *b = fixed_work + (i + span) * 2;
+                int32_t tr = (b[0] * wr - b[1] * wi + (1L << 14)) >> 15;
+                int32_t ti = (b[0] * wi + b[1] * wr + (1L << 14)) >> 15;
+                b[0] = (int16_t)((a[0] - tr + 1) >> 1);
+                b[1] = (int16_t)((a[1] - ti + 1) >> 1);
+                a[0] = (int16_t)((a[0] + tr + 1) >> 1);
+                a[1] = (int16_t)((a[1] + ti + 1) >> 1);
+            }
+        }
+    }
+
+    for (uint16_t k = 0; k <= half; k++)
+    {
+        const int16_t *z = fixed_work + (k % half) * 2, *c = fixed_work + ((half - k) % half) * 2;
+        int32_t er = (z[0] + c[0]) / 2, ei = (z[1] - c[1]) / 2;
+        int32_t or_ = (z[1] + c[1]) / 2, oi = (c[0] - z[0]) / 2;
+        int32_t wr = getFixedCos(k), ws = getFixedSin(k);
+        int32_t re = er + ((wr * or_ + ws * oi) >> 15);
+        int32_t im = ei + ((wr * oi - ws * or_) >> 15);
+        uint32_t squares = (uint32_t)re * (uint32_t)re + (uint32_t)im * (uint32_t)im;
+        uint32_t amplitude = ((uint32_t)BMA400Tilt::Sqrt(squares) * fixed_gain) >>
+                             (k == 0 || k == half ? 9 : 8);
+        fixed_magnitudes[axis][k] = amplitude > 65535 ? 65535 : amplitude;
+    }
+}
+
+float BMA400Spectrum::getCos(uint16_t k)
+{
+    uint16_t quarter = size / 4;
+    return k <= quarter ? sine[quarter - k] : -sine[k - quarter];
+}
+
+float BMA400Spectrum::getSin(uint16_t k)
+{
+    return k <= size / 4 ? sine[k] : sine[size / 2 - k];
+}
+
+int16_t BMA400Spectrum::getFixedCos(uint16_t k)
+{
+    uint16_t quarter = size / 4;
+    return k <= quarter ? fixed_sine[quarter - k] : -fixed_sine[k - quarter];
+}
+
+int16_t BMA400Spectrum::getFixedSin(uint16_t k)
+{
+    return k <= size / 4 ? fixed_sine[k] : fixed_sine[size / 2 - k];
+}
+
+uint16_t BMA400Spectrum::reverse(uint16_t index)
+{
+    uint16_t result = 0;
+    for (uint8_t bit = 0; bit < stages; bit++)
+    {
+        result = (result << 1) | (index & 1);
+        index >>= 1;
+    }
+    return result;
+}
@@ -0,0 +1,120 @@
+/*!
+ * @file BMA400Spectrum.h
+ *
+ *  Vibration spectrum analysis on FIFO windows for the BMA400 library.
+ *
+ *  Samples (e.g. the blocks of a BMA400FifoStream) are collected into windows of a
+ *  power of two length. For each full window the mean of every axis is removed (gravity),
+ *  a window function is applied and a real-input FFT (N/2 point complex FFT + split) gives
+ *  the amplitude spectrum of X, Y and Z. Twiddle factors and the window function are
+ *  tabulated by Begin, so a window costs no trigonometry.
+ *
+ *  Two variants with the same results:
+ *  - FORMAT_FLOAT: float FFT, amplitudes in raw LSB.
+ *  - FORMAT_FIXED: Q15 FFT scaled by 1/2 per stage (no overflow, no float), amplitudes in
+ *    1/16 raw LSB. For targets without FPU.
+ *
+ *  Amplitudes are those of a sinusoid at the bin frequency (raw LSB, see BMA400::SetRange
+ *  for the scale). Band energies (mean square in LSB^2, corrected for the equivalent noise
+ *  bandwidth of the window) allow shipping a few numbers per window instead of raw data.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#ifndef BMA400_SPECTRUM_SIZE
+#define BMA400_SPECTRUM_SIZE 256 // maximum window length (power of two)
+#endif
+
+#ifndef BMA400_SPECTRUM_BANDS
+#define BMA400_SPECTRUM_BANDS 8 // maximum number of bands
+#endif
+
+class BMA400Spectrum
+{
+public:
+    typedef enum // window functions
+    {
+        WINDOW_RECTANGULAR, // no window. best frequency resolution, strong leakage
+        WINDOW_HANN,        // general purpose
+        WINDOW_HAMMING,     // lower first side lobe than Hann
+        WINDOW_FLAT_TOP,    // accurate amplitudes between bins, wide peaks
+    } window_t;
+
+    typedef enum // arithmetic of the FFT
+    {
+        FORMAT_FLOAT, // float FFT, amplitudes in raw LSB
+        FORMAT_FIXED, // Q15 FFT, amplitudes in 1/16 raw LSB
+    } format_t;
+
+    typedef void (*spectrum_callback_t)(BMA400Spectrum &spectrum, void *context);
+
+    bool Begin(uint16_t size, float sample_rate, window_t function = window_t::WINDOW_HANN, format_t format = format_t::FORMAT_FLOAT);
+    bool ConfigureBands(const float *edges, uint8_t bands);
+    void SetCallback(spectrum_callback_t callback, void *context = nullptr);
+
+    uint16_t Add(const int16_t *samples, uint16_t count);
+    uint16_t Add(const BMA400::sample_block_t &block);
+    void Reset();
+
+    uint16_t GetBinCount();
+    float GetBinFrequency(uint16_t bin);
+    const float *GetMagnitudes(uint8_t axis);
+    const uint16_t *GetFixedMagnitudes(uint8_t axis);
+    float GetMagnitude(uint8_t axis, uint16_t bin);
+    float GetBandEnergy(uint8_t axis, uint8_t band);
+    uint32_t GetWindows();
+
+private:
+    uint16_t size = 0;
+    uint8_t stages = 0; // log2 of the complex FFT length (size / 2)
+    float sample_rate = 0;
+    format_t format = format_t::FORMAT_FLOAT;
+    float gain = 0;            // FFT magnitude to amplitude
+    uint16_t fixed_gain = 0;   // Q8, FFT magnitude to 1/16 LSB amplitude
+    float noise_bandwidth = 1; // equivalent noise bandwidth of the window in bins
+
+    //# tables of the selected format: quarter wave sine and the first half of the (symmetric) window
+    union
+    {
+        float sine[BMA400_SPECTRUM_SIZE / 4 + 1];
+        int16_t fixed_sine[BMA400_SPECTRUM_SIZE / 4 + 1];
+    };
+    union
+    {
+        float window[BMA400_SPECTRUM_SIZE / 2 + 1];
+        int16_t fixed_window[BMA400_SPECTRUM_SIZE / 2 + 1];
+    };
+
+    int16_t samples[3][BMA400_SPECTRUM_SIZE];
+    uint16_t fill = 0;
+    union
+    {
+        float work[BMA400_SPECTRUM_SIZE];
+        int16_t fixed_work[BMA400_SPECTRUM_SIZE];
+    };
+    union
+    {
+        float magnitudes[3][BMA400_SPECTRUM_SIZE / 2 + 1];
+        uint16_t fixed_magnitudes[3][BMA400_SPECTRUM_SIZE / 2 + 1];
+    };
+
+    uint16_t band_edges[BMA400_SPECTRUM_BANDS + 1]; // first bin of each band
+    uint8_t bands = 0;
+    uint32_t windows = 0;
+    spectrum_callback_t callback = nullptr;
+    void *context = nullptr;
+
+    void process();
+    void transform(uint8_t axis);
+    void transformFixed(uint8_t axis);
+    float getCos(uint16_t k);
+    float getSin(uint16_t k);
+    int16_t getFixedCos(uint16_t k);
+    int16_t getFixedSin(uint16_t k);
+    uint16_t reverse(uint16_t index);
+};
@@ -0,0 +1,233 @@
+/*!
+ * @file BMA400Statistics.cpp
+ *
+ *  Streaming statistics over raw acceleration samples for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Statistics.h>
+
+#define BMA400_STATISTICS_CHUNK 256 // samples per 32 bit partial sum (256 x 2048^2 < 2^31)
+
+/*!
+ *  @brief  Clearing the accumulators (start of a new window)
+ */
+void BMA400Statistics::Reset()
+{
+    count = 0;
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        sum[axis] = 0;
+        squares[axis] = 0;
+        minimum[axis] = INT16_MAX;
+        maximum[axis] = INT16_MIN;
+    }
+    magnitude_min = UINT32_MAX;
+    magnitude_max = 0;
+}
+
+/*!
+ *  @brief  Adding raw samples
+ *  @param  values raw samples ordered as X Y Z X Y Z ... (ReadAcceleration/ReadFifo output)
+ *  @param  samples number of samples (XYZ triplets)
+ */
+void BMA400Statistics::Add(const int16_t *values, uint16_t samples)
+{
+    while (samples > 0)
+    {
+        uint16_t length = samples > BMA400_STATISTICS_CHUNK ? BMA400_STATISTICS_CHUNK : samples;
+        int32_t sx = 0, sy = 0, sz = 0;
+        uint32_t qx = 0, qy = 0, qz = 0;
+        int16_t min_x = minimum[0], min_y = minimum[1], min_z = minimum[2];
+        int16_t max_x = maximum[0], max_y = maximum[1], max_z = maximum[2];
+        uint32_t min_m = magnitude_min, max_m = magnitude_max;
+
+        for (uint16_t i = 0; i < length; i++)
+        {
+            int32_t x = values[i * 3];
+            int32_t y = values[i * 3 + 1];
+            int32_t z = values[i * 3 + 2];
+            uint32_t xx = x * x, yy = y * y, zz = z * z;
+            sx += x;
+            sy += y;
+            sz += z;
+            qx += xx;
+            qy += yy;
+            qz += zz;
+            min_x = x < min_x ? x : min_x;
+            min_y = y < min_y ? y : min_y;
+            min_z = z < min_z ? z : min_z;
+            max_x = x > max_x ? x : max_x;
+            max_y = y > max_y ? y : max_y;
+            max_z = z > max_z ? z : max_z;
+            uint32_t m = xx + yy + zz;
+            min_m = m < min_m ? m : min_m;
+            max_m = m > max_m ? m : max_m;
+        }
+
+        sum[0] += sx;
+        sum[1] += sy;
+        sum[2] += sz;
+        squares[0] += qx;
+        squares[1] += qy;
+        squares[2] += qz;
+        minimum[0] = min_x;
+        minimum[1] = min_y;
+        minimum[2] = min_z;
+        maximum[0] = max_x;
+        maximum[1] = max_y;
+        maximum[2] = max_z;
+        magnitude_min = min_m;
+        magnitude_max = max_m;
+
+        count += length;
+        values += length * 3;
+        samples -= length;
+    }
+}
+
+/*!
+ *  @brief  Adding the samples of a block
+ *  @param  block block filled by ReadFifo/ReadAcceleration
+ */
+void BMA400Statistics::Add(const BMA400::sample_block_t &block)
+{
+    Add(block.values, block.count);
+}
+
+/*!
+ *  @brief  Merging the accumulators of another window/sensor/task. The result is exactly the same
+ *          as adding all samples to one accumulator
+ *  @param  other accumulators to merge
+ */
+void BMA400Statistics::Merge(const BMA400Statistics &other)
+{
+    count += other.count;
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        sum[axis] += other.sum[axis];
+        squares[axis] += other.squares[axis];
+        if (other.minimum[axis] < minimum[axis])
+            minimum[axis] = other.minimum[axis];
+        if (other.maximum[axis] > maximum[axis])
+            maximum[axis] = other.maximum[axis];
+    }
+    if (other.magnitude_min < magnitude_min)
+        magnitude_min = other.magnitude_min;
+    if (other.magnitude_max > magnitude_max)
+        magnitude_max = other.magnitude_max;
+}
+
+/*!
+ *  @brief  Getting the number of samples
+ *  @return number of samples
+ */
+uint32_t BMA400Statistics::GetCount()
+{
+    return count;
+}
+
+/*!
+ *  @brief  Getting the minimum of an axis
+ *  @param  axis 0 = X, 1 = Y, 2 = Z
+ *  @return minimum (raw). 0 without samples
+ */
+int16_t BMA400Statistics::GetMin(uint8_t axis)
+{
+    return count > 0 && axis < 3 ? minimum[axis] : 0;
+}
+
+/*!
+ *  @brief  Getting the maximum of an axis
+ *  @param  axis 0 = X, 1 = Y, 2 = Z
+ *  @return maximum (raw). 0 without samples
+ */
+int16_t BMA400Statistics::GetMax(uint8_t axis)
+{
+    return count > 0 && axis < 3 ? maximum[axis] : 0;
+}
+
+/*!
+ *  @brief  Getting the mean of an axis
+ *  @param  axis 0 = X, 1 = Y, 2 = Z
+ *  @return mean (raw)
+ */
+float BMA400Statistics::GetMean(uint8_t axis)
+{
+    if (count == 0 || axis > 2)
+        return 0;
+    return (double)sum[axis] / count;
+}
+
+/*!
+ *  @brief  Getting the (population) variance of an axis
+ *  @param  axis 0 = X, 1 = Y, 2 = Z
+ *  @return variance (raw^2)
+ */
+float BMA400Statistics::GetVariance(uint8_t axis)
+{
+    if (count == 0 || axis > 2)
+        return 0;
+
+    //# sum of squared deviations around the integer part of the mean, exact in 64 bit:
+    //# S2 - S^2/n with S = q*n + r  ->  S2 - q*q*n - 2*q*r - r*r/n
+    int64_t q = sum[axis] / (int64_t)count;
+    int64_t r = sum[axis] - q * (int64_t)count;
+    int64_t deviation = (int64_t)squares[axis] - q * q * (int64_t)count - 2 * q * r;
+    double m2 = (double)deviation - (double)r * r / count;
+    return m2 > 0 ? m2 / count : 0;
+}
+
+/*!
+ *  @brief  Getting the standard deviation of an axis
+ *  @param  axis 0 = X, 1 = Y, 2 = Z
+ *  @return standard deviation (raw)
+ */
+float BMA400Statistics::GetStandardDeviation(uint8_t axis)
+{
+    return sqrt(GetVariance(axis));
+}
+
+/*!
+ *  @brief  Getting the RMS of an axis (including the mean, e.g. gravity)
+ *  @param  axis 0 = X, 1 = Y, 2 = Z
+ *  @return RMS (raw)
+ */
+float BMA400Statistics::GetRms(uint8_t axis)
+{
+    if (count == 0 || axis > 2)
+        return 0;
+    return sqrt((double)squares[axis] / count);
+}
+
+/*!
+ *  @brief  Getting the RMS of the vector magnitude sqrt(mean(x^2 + y^2 + z^2))
+ *  @return magnitude RMS (raw)
+ */
+float BMA400Statistics::GetMagnitudeRms()
+{
+    if (count == 0)
+        return 0;
+    return sqrt((double)(squares[0] + squares[1] + squares[2]) / count);
+}
+
+/*!
+ *  @brief  Getting the smallest vector magnitude
+ *  @return minimum magnitude (raw)
+ */
+float BMA400Statistics::GetMagnitudeMin()
+{
+    return count > 0 ? sqrt((double)magnitude_min) : 0;
+}
+
+/*!
+ *  @brief  Getting the largest vector magnitude
+ *  @return maximum magnitude (raw)
+ */
+float BMA400Statistics::GetMagnitudeMax()
+{
+    return sqrt((double)magnitude_max);
+}
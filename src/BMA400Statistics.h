@@ -0,0 +1,51 @@
+/*!
+ * @file BMA400Statistics.h
+ *
+ *  Streaming statistics over raw acceleration samples for the BMA400 library.
+ *
+ *  Samples (raw int16_t X Y Z, e.g. a FIFO batch or a sample block) are accumulated in
+ *  integers: per axis count, sum, sum of squares, min and max, plus the min/max squared
+ *  vector magnitude. The sums are exact, so accumulators of several windows, sensors or
+ *  tasks can be merged in any order without losing precision. Mean, variance (computed
+ *  around the integer mean, no cancellation), standard deviation, RMS and magnitudes are
+ *  derived only when read. The inner loop has no branches besides min/max and works on
+ *  chunks with 32 bit partial sums, so compilers can vectorize it.
+ *
+ *  All results are in raw LSB (see BMA400::SetRange for the scale).
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+class BMA400Statistics
+{
+public:
+    void Reset();
+    void Add(const int16_t *values, uint16_t count);
+    void Add(const BMA400::sample_block_t &block);
+    void Merge(const BMA400Statistics &other);
+
+    uint32_t GetCount();
+    int16_t GetMin(uint8_t axis);
+    int16_t GetMax(uint8_t axis);
+    float GetMean(uint8_t axis);
+    float GetVariance(uint8_t axis);
+    float GetStandardDeviation(uint8_t axis);
+    float GetRms(uint8_t axis);
+    float GetMagnitudeRms();
+    float GetMagnitudeMin();
+    float GetMagnitudeMax();
+
+private:
+    uint32_t count = 0;
+    int64_t sum[3] = {0, 0, 0};
+    uint64_t squares[3] = {0, 0, 0};
+    int16_t minimum[3] = {INT16_MAX, INT16_MAX, INT16_MAX};
+    int16_t maximum[3] = {INT16_MIN, INT16_MIN, INT16_MIN};
+    uint32_t magnitude_min = UINT32_MAX; // squared
+    uint32_t magnitude_max = 0;          // squared
+};
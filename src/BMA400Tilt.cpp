@@ -0,0 +1,205 @@
+/*!
+ * @file BMA400Tilt.cpp
+ *
+ *  Fixed-point tilt (pitch, roll, inclination) for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Tilt.h>
+
+//# atan(t) for 0 <= t <= 1: t * (1 - 0.3302995 t^2 + 0.1801410 t^4 - 0.0851330 t^6 + 0.0208351 t^8)
+//# coefficients in 0.01 degree * 8
+static const int32_t BMA400_ATAN_COEFFICIENTS[5] = {45837, -15140, 8257, -3902, 955};
+
+/*!
+ *  @brief  Setting the reference vector used for the inclination. Only the direction is used
+ *  @param  values raw X Y Z (e.g. a sample taken at the rest position)
+ */
+void BMA400Tilt::SetReference(const int16_t *values)
+{
+    if (values[0] == 0 && values[1] == 0 && values[2] == 0)
+        return;
+
+    for (uint8_t axis = 0; axis < 3; axis++)
+        reference[axis] = values[axis];
+}
+
+/*!
+ *  @brief  Using the reference vector of the on-chip orientation engine (see SetOrientationReference)
+ *  @param  sensor initialized BMA400 sensor
+ *  @return true if the reference was read and is not zero
+ */
+bool BMA400Tilt::SetReference(BMA400 &sensor)
+{
+    int16_t values[3];
+    if (!sensor.GetOrientationReference(values) || (values[0] == 0 && values[1] == 0 && values[2] == 0))
+        return false;
+
+    SetReference(values);
+    return true;
+}
+
+/*!
+ *  @brief  Using the Z axis as reference vector for the inclination
+ */
+void BMA400Tilt::ResetReference()
+{
+    reference[0] = 0;
+    reference[1] = 0;
+    reference[2] = 1;
+}
+
+/*!
+ *  @brief  Computing the angles of one sample
+ *  @param  values raw X Y Z (12 bit, as read by ReadAcceleration)
+ *  @return pitch, roll and inclination in 0.01 degree
+ */
+BMA400Tilt::tilt_t BMA400Tilt::Compute(const int16_t *values)
+{
+    int32_t x = values[0], y = values[1], z = values[2];
+    tilt_t result;
+    result.roll = Atan2(y, z);
+    int32_t opposite = -x;
+    uint16_t adjacent = root((uint32_t)(y * y) + (uint32_t)(z * z), opposite);
+    result.pitch = Atan2(opposite, adjacent);
+
+    //# angle to the reference: atan2(|a x r|, a . r)
+    int32_t cross[3] = {y * reference[2] - z * reference[1],
+                        z * reference[0] - x * reference[2],
+                        x * reference[1] - y * reference[0]};
+    int32_t dot = x * reference[0] + y * reference[1] + z * reference[2];
+
+    //# scaling the cross product down so its squared length fits 32 bit, the dot product follows
+    uint8_t shift = 0;
+    while (true)
+    {
+        int32_t limit = (int32_t)1 << (15 + shift);
+        if (cross[0] < limit && cross[0] > -limit && cross[1] < limit && cross[1] > -limit &&
+            cross[2] < limit && cross[2] > -limit)
+            break;
+        shift++;
+    }
+
+    uint32_t squares = 0;
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        int32_t value = cross[axis] >> shift;
+        squares += (uint32_t)(value * value);
+    }
+    dot >>= shift;
+    uint16_t length = root(squares, dot);
+    result.inclination = Atan2(length, dot);
+    return result;
+}
+
+/*!
+ *  @brief  Computing the angles of a batch of samples (e.g. a FIFO drain)
+ *  @param  samples raw samples ordered as X Y Z X Y Z ...
+ *  @param  count number of samples (XYZ triplets)
+ *  @param  results receives one result per sample
+ */
+void BMA400Tilt::Compute(const int16_t *samples, uint16_t count, tilt_t *results)
+{
+    for (uint16_t i = 0; i < count; i++)
+        results[i] = Compute(samples + i * 3);
+}
+
+/*!
+ *  @brief  Computing the angles of the mean of a block. Averaging first reduces noise and costs one atan2 set
+ *  @param  block block filled by ReadFifo
+ *  @return pitch, roll and inclination in 0.01 degree. zero if the block is empty
+ */
+BMA400Tilt::tilt_t BMA400Tilt::Compute(const BMA400::sample_block_t &block)
+{
+    tilt_t result = {0, 0, 0};
+    if (block.count == 0)
+        return result;
+
+    int32_t sum[3] = {0};
+    for (uint16_t i = 0; i < block.count; i++)
+        for (uint8_t axis = 0; axis < 3; axis++)
+            sum[axis] += block.values[i * 3 + axis];
+
+    int16_t mean[3];
+    int32_t half = block.count / 2;
+    for (uint8_t axis = 0; axis < 3; axis++)
+        mean[axis] = (sum[axis] + (sum[axis] < 0 ? -half : half)) / block.count;
+    return Compute(mean);
+}
+
+/*!
+ *  @brief  Fixed-point atan2
+ *  @param  y
+ *  @param  x
+ *  @return angle in 0.01 degree (-18000..18000). 0 for (0, 0)
+ */
+int16_t BMA400Tilt::Atan2(int32_t y, int32_t x)
+{
+    uint32_t ax = x < 0 ? -(uint32_t)x : x;
+    uint32_t ay = y < 0 ? -(uint32_t)y : y;
+    if (ax == 0 && ay == 0)
+        return 0;
+
+    while (ax >= 65536 || ay >= 65536)
+    {
+        ax >>= 1;
+        ay >>= 1;
+    }
+
+    //# ratio of the octant in Q15
+    bool steep = ay > ax;
+    int32_t t = steep ? (ax << 15) / ay : (ay << 15) / ax;
+    int32_t t2 = (t * t) >> 15;
+
+    int32_t p = BMA400_ATAN_COEFFICIENTS[4];
+    for (int8_t i = 3; i >= 0; i--)
+        p = BMA400_ATAN_COEFFICIENTS[i] + ((p * t2) >> 15);
+    int32_t angle = (p * t + (1L << 17)) >> 18;
+
+    if (steep)
+        angle = 9000 - angle;
+    if (x < 0)
+        angle = 18000 - angle;
+    return y < 0 ? -angle : angle;
+}
+
+/*!
+ *  @brief  Integer square root
+ *  @param  value
+ *  @return floor(sqrt(value))
+ */
+uint16_t BMA400Tilt::Sqrt(uint32_t value)
+{
+    uint32_t result = 0;
+    uint32_t bit = (uint32_t)1 << 30;
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+            result >>= 1;
+        bit >>= 2;
+    }
+    return result;
+}
+
+//* Private methods
+uint16_t BMA400Tilt::root(uint32_t squares, int32_t &value)
+{
+    //# scaling both sides up keeps the precision of the square root for small vectors
+    while (squares != 0 && squares < ((uint32_t)1 << 28) && value < (1L << 24) && value > -(1L << 24))
+    {
+        squares <<= 2;
+        value *= 2;
+    }
+    return Sqrt(squares);
+}
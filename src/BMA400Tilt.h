@@ -0,0 +1,51 @@
+/*!
+ * @file BMA400Tilt.h
+ *
+ *  Fixed-point tilt (pitch, roll, inclination) for the BMA400 library.
+ *
+ *  Angles are computed straight from raw 12 bit samples with integer arithmetic only
+ *  (no float, no 64 bit): atan2 is an odd polynomial on the octant ratio (Abramowitz &
+ *  Stegun 4.4.48) evaluated in Q15, and magnitudes use a bitwise integer square root.
+ *  The error is below 0.02 degree against atan2 for any pair of 12 bit values.
+ *
+ *  Angles are in 0.01 degree:
+ *  - roll: rotation around X, atan2(Y, Z). -18000..18000
+ *  - pitch: rotation around Y, atan2(-X, sqrt(Y^2 + Z^2)). -9000..9000
+ *  - inclination: angle between the acceleration and a reference vector. 0..18000
+ *  The reference defaults to the Z axis (sensor lying flat) and can be set from a sample
+ *  or from the reference vector of the on-chip orientation engine.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+class BMA400Tilt
+{
+public:
+    typedef struct // angles in 0.01 degree
+    {
+        int16_t pitch;
+        int16_t roll;
+        int16_t inclination;
+    } tilt_t;
+
+    void SetReference(const int16_t *values);
+    bool SetReference(BMA400 &sensor);
+    void ResetReference();
+
+    tilt_t Compute(const int16_t *values);
+    void Compute(const int16_t *samples, uint16_t count, tilt_t *results);
+    tilt_t Compute(const BMA400::sample_block_t &block);
+
+    static int16_t Atan2(int32_t y, int32_t x);
+    static uint16_t Sqrt(uint32_t value);
+
+private:
+    int16_t reference[3] = {0, 0, 1};
+
+    static uint16_t root(uint32_t squares, int32_t &value);
+};
@@ -0,0 +1,335 @@
+/*!
+ * @file BMA400Watchdog.cpp
+ *
+ *  Signal health watchdog with automatic recovery for the BMA400 library.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#include <BMA400Watchdog.h>
+
+#define BMA400_WATCHDOG_RESET_DELAY 5 // ms after a soft reset before the configuration is written
+
+#define BMA400_WATCHDOG_INDEX(reg) ((reg)-BMA400_WATCHDOG_FIRST)
+
+static const uint8_t reserved_registers[] = {0x1C, 0x1D, 0x1E, 0x25, 0x2E, 0x34, 0x37};
+
+/*!
+ *  @brief  Starting the watchdog with a shadow of the current configuration (see Capture)
+ *  @param  _sensor initialized and configured BMA400 sensor
+ *  @param  _interval time (ms) between checks run by Update
+ *  @param  _stalled_checks consecutive checks without progress raising a data/time stall
+ *  @return true if the configuration could be read
+ */
+bool BMA400Watchdog::Begin(BMA400 &_sensor, uint32_t _interval, uint8_t _stalled_checks)
+{
+    sensor = &_sensor;
+    interval = _interval;
+    stalled_checks = _stalled_checks > 0 ? _stalled_checks : 1;
+    last_faults = FAULT_NONE;
+    ResetCounters();
+    return Capture();
+}
+
+/*!
+ *  @brief  Taking the configuration of the chip as the known good one. Call it after every
+ *  intended configuration change
+ *  @return true if the configuration could be read
+ */
+bool BMA400Watchdog::Capture()
+{
+    captured = false;
+    if (sensor == nullptr || sensor->ReadRegisters(BMA400_WATCHDOG_FIRST, shadow, BMA400_WATCHDOG_SIZE) != BMA400::bus_status_t::BUS_OK)
+        return false;
+
+    buildMask();
+    shadow_crc = crc(shadow);
+    captured = true;
+    progress_valid = false;
+    data_stalls = 0;
+    time_stalls = 0;
+    escalate = false;
+    last_check = millis();
+    return true;
+}
+
+/*!
+ *  @brief  Setting the cadence of the checks
+ *  @param  _interval time (ms) between checks run by Update
+ */
+void BMA400Watchdog::SetInterval(uint32_t _interval)
+{
+    interval = _interval;
+}
+
+/*!
+ *  @brief  Setting the function called after every failed check (once the recovery was done)
+ *  @param  _callback called with the watchdog_fault_t flags. nullptr disables it
+ *  @param  _context passed to the callback
+ */
+void BMA400Watchdog::SetCallback(watchdog_callback_t _callback, void *_context)
+{
+    callback = _callback;
+    context = _context;
+}
+
+/*!
+ *  @brief  Running a check if the interval elapsed. Call it from the main loop
+ *  @return watchdog_fault_t flags of the check. FAULT_NONE if healthy or no check was due
+ */
+uint8_t BMA400Watchdog::Update()
+{
+    if (!captured || millis() - last_check < interval)
+        return FAULT_NONE;
+    return Check();
+}
+
+/*!
+ *  @brief  Checking the sensor now and recovering it on failure
+ *  @return watchdog_fault_t flags of the check
+ */
+uint8_t BMA400Watchdog::Check()
+{
+    if (!captured)
+        return FAULT_NONE;
+
+    last_check = millis();
+    counters.checks++;
+
+    uint8_t chip[BMA400_WATCHDOG_SIZE];
+    uint8_t faults = checkProgress(last_check);
+    faults |= checkConfiguration(chip);
+
+    if ((faults & FAULT_BUS) != 0)
+        counters.bus++;
+    if ((faults & FAULT_DATA_STALLED) != 0)
+        counters.data_stalled++;
+    if ((faults & FAULT_TIME_STALLED) != 0)
+        counters.time_stalled++;
+    if ((faults & FAULT_CONFIG) != 0)
+        counters.config++;
+
+    //# bus errors are handled (retried, recovered) by the bus layer, the chip state is unknown
+    if ((faults & (FAULT_DATA_STALLED | FAULT_TIME_STALLED | FAULT_CONFIG)) != 0)
+    {
+        if (!recover(faults, chip))
+            faults |= FAULT_SHADOW;
+    }
+
+    last_faults = faults;
+    if (faults != FAULT_NONE && callback != nullptr)
+        callback(faults, context);
+    return faults;
+}
+
+/*!
+ *  @brief  Getting the result of the last check
+ *  @return watchdog_fault_t flags
+ */
+uint8_t BMA400Watchdog::GetLastFaults()
+{
+    return last_faults;
+}
+
+/*!
+ *  @brief  Getting the CRC of the shadowed configuration (e.g. to compare configurations of devices)
+ *  @return CRC-8 (polynomial 0x07) of the compared bits
+ */
+uint8_t BMA400Watchdog::GetShadowCrc()
+{
+    return shadow_crc;
+}
+
+/*!
+ *  @brief  Getting the incident counters
+ *  @param  _counters receives the counters
+ */
+void BMA400Watchdog::GetCounters(watchdog_counters_t &_counters)
+{
+    _counters = counters;
+}
+
+/*!
+ *  @brief  Clearing the incident counters
+ */
+void BMA400Watchdog::ResetCounters()
+{
+    counters = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+//* Private methods
+uint8_t BMA400Watchdog::checkProgress(uint32_t now)
+{
+    //# STATUS, ACC_DATA and SENSOR_TIME in one burst
+    uint8_t values[10];
+    if (sensor->ReadRegisters(BMA400_REG_STATUS, values, sizeof(values)) != BMA400::bus_status_t::BUS_OK)
+        return FAULT_BUS;
+
+    uint8_t faults = FAULT_NONE;
+    uint32_t time = values[7] | (uint32_t)values[8] << 8 | (uint32_t)values[9] << 16;
+    bool sleeping = (values[0] & 0x06) == 0;
+    uint32_t elapsed = now - last_progress;
+
+    //# the 24 bit sensor time wraps after 5242 s
+    if (progress_valid && !sleeping && elapsed < 5000000)
+    {
+        bool changed = (values[0] & 0x80) != 0;
+        for (uint8_t i = 0; i < 6 && !changed; i++)
+            changed = values[1 + i] != last_data[i];
+        data_stalls = changed ? 0 : data_stalls + 1;
+
+        uint32_t ticks = (time - last_time) & 0xFFFFFF;
+        uint32_t expected = elapsed * 16 / 5; //# 312.5us per tick
+        time_stalls = ticks == 0 || ticks < expected / 2 ? time_stalls + 1 : 0;
+
+        //# progress seen since the power mode restart, a later stall starts over
+        if (data_stalls == 0 && time_stalls == 0)
+            escalate = false;
+
+        if (data_stalls >= stalled_checks)
+            faults |= FAULT_DATA_STALLED;
+        if (time_stalls >= stalled_checks)
+            faults |= FAULT_TIME_STALLED;
+    }
+
+    for (uint8_t i = 0; i < 6; i++)
+        last_data[i] = values[1 + i];
+    last_time = time;
+    last_progress = now;
+    progress_valid = true;
+    return faults;
+}
+
+uint8_t BMA400Watchdog::checkConfiguration(uint8_t *chip)
+{
+    if (sensor->ReadRegisters(BMA400_WATCHDOG_FIRST, chip, BMA400_WATCHDOG_SIZE) != BMA400::bus_status_t::BUS_OK)
+        return FAULT_BUS;
+    return crc(chip) != shadow_crc ? FAULT_CONFIG : FAULT_NONE;
+}
+
+bool BMA400Watchdog::recover(uint8_t faults, const uint8_t *chip)
+{
+    //# never writing back a corrupted shadow
+    if (crc(shadow) != shadow_crc)
+    {
+        counters.shadow++;
+        return false;
+    }
+
+    bool stalled = (faults & (FAULT_DATA_STALLED | FAULT_TIME_STALLED)) != 0;
+    if (stalled && escalate)
+    {
+        //# restarting did not help: soft reset (without waiting for cmd_rdy) and writing everything back
+        uint8_t command = BMA400::command_t::CMD_SOFT_RESET;
+        sensor->WriteRegisters(BMA400_REG_COMMAND, &command, 1);
+        delay(BMA400_WATCHDOG_RESET_DELAY);
+        counters.resets++;
+        restore(nullptr);
+        escalate = false;
+    }
+    else
+    {
+        if ((faults & FAULT_CONFIG) != 0 && (faults & FAULT_BUS) == 0)
+            restore(chip);
+
+        if (stalled)
+        {
+            //# restarting the data path: sleep and back to the shadowed power mode
+            uint8_t sleep = shadow[0] & 0xFC;
+            sensor->WriteRegisters(BMA400_REG_ACC_CONFIG_0, &sleep, 1);
+            sensor->WriteRegisters(BMA400_REG_ACC_CONFIG_0, shadow, 1);
+            counters.registers += 2;
+            escalate = true;
+        }
+    }
+
+    if (stalled)
+    {
+        progress_valid = false;
+        data_stalls = 0;
+        time_stalls = 0;
+    }
+    return true;
+}
+
+void BMA400Watchdog::restore(const uint8_t *chip)
+{
+    //# bursts of consecutive differing registers (all after a reset), ACC_CONFIG_0 (power mode) last
+    uint8_t index = 1;
+    while (index < BMA400_WATCHDOG_SIZE)
+    {
+        uint8_t start = index;
+        while (index < BMA400_WATCHDOG_SIZE && isWritable(index) &&
+               (chip == nullptr || ((chip[index] ^ shadow[index]) & mask[index]) != 0))
+            index++;
+
+        if (index == start)
+        {
+            index++;
+            continue;
+        }
+        sensor->WriteRegisters(BMA400_WATCHDOG_FIRST + start, shadow + start, index - start);
+        counters.registers += index - start;
+    }
+
+    if (chip == nullptr || ((chip[0] ^ shadow[0]) & mask[0]) != 0)
+    {
+        sensor->WriteRegisters(BMA400_WATCHDOG_FIRST, shadow, 1);
+        counters.registers++;
+    }
+    counters.restores++;
+}
+
+void BMA400Watchdog::buildMask()
+{
+    for (uint8_t i = 0; i < BMA400_WATCHDOG_SIZE; i++)
+        mask[i] = isWritable(i) ? 0xFF : 0x00;
+
+    //# references updated by the chip: wake-up, orientation and generic interrupts in automatic modes
+    const struct
+    {
+        uint8_t config;
+        uint8_t bits;
+        uint8_t reference;
+    } engines[] = {
+        {BMA400_REG_WKUP_INT_CONFIG_0, 0x03, BMA400_REG_WKUP_INT_CONFIG_2},
+        {BMA400_REG_ORIENT_CONFIG_0, 0x0C, BMA400_REG_ORIENT_CONFIG_4},
+        {BMA400_REG_GEN_INT_1_CONFIG, 0x0C, BMA400_REG_GEN_INT_1_CONFIG + 5},
+        {BMA400_REG_GEN_INT_2_CONFIG, 0x0C, BMA400_REG_GEN_INT_2_CONFIG + 5},
+    };
+    for (uint8_t i = 0; i < sizeof(engines) / sizeof(engines[0]); i++)
+    {
+        if ((shadow[BMA400_WATCHDOG_INDEX(engines[i].config)] & engines[i].bits) == 0)
+            continue;
+        uint8_t length = engines[i].config == BMA400_REG_WKUP_INT_CONFIG_0 ? 3 : 6;
+        for (uint8_t j = 0; j < length; j++)
+            mask[BMA400_WATCHDOG_INDEX(engines[i].reference) + j] = 0x00;
+    }
+
+    //# power mode changed by auto low power / auto wake-up
+    if ((shadow[BMA400_WATCHDOG_INDEX(BMA400_REG_AUTO_LOW_POW_1)] & 0x0F) != 0 ||
+        (shadow[BMA400_WATCHDOG_INDEX(BMA400_REG_AUTO_WAKEUP_1)] & 0x06) != 0)
+        mask[0] = 0xFC;
+}
+
+uint8_t BMA400Watchdog::crc(const uint8_t *values)
+{
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < BMA400_WATCHDOG_SIZE; i++)
+    {
+        value ^= values[i] & mask[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            value = (value & 0x80) != 0 ? (value << 1) ^ 0x07 : value << 1;
+    }
+    return value;
+}
+
+bool BMA400Watchdog::isWritable(uint8_t index)
+{
+    for (uint8_t i = 0; i < sizeof(reserved_registers); i++)
+        if (BMA400_WATCHDOG_FIRST + index == reserved_registers[i])
+            return false;
+    return true;
+}
@@ -0,0 +1,107 @@
+/*!
+ * @file BMA400Watchdog.h
+ *
+ *  Signal health watchdog with automatic recovery for the BMA400 library.
+ *
+ *  Capture takes a shadow copy of the configuration registers (ACC_CONFIG_0 up to
+ *  TAP_CONFIG_1) and its CRC. At a configurable cadence Update then checks that:
+ *  - the data keeps progressing: data ready flag set or acceleration changed
+ *  - the sensor time keeps advancing at roughly the rate of millis()
+ *  - the CRC of the configuration read from the chip matches the shadow
+ *  A check costs two burst reads (STATUS to SENSOR_TIME, and the configuration).
+ *  Data and time are not checked in sleep mode. Registers changed by the chip itself
+ *  (references of auto-updated engines, power mode with auto low power / wake-up) are
+ *  excluded from the CRC.
+ *
+ *  On a configuration mismatch only the registers differing from the shadow are written
+ *  back (in bursts of consecutive registers). Stalled data or time first restarts the
+ *  power mode; if the next check still fails the chip is soft reset and the whole shadow
+ *  is written back. Every incident is counted per cause.
+ *
+ *  Call Capture again after intentionally changing the configuration, otherwise the
+ *  watchdog reverts the change.
+ *
+ *  @section license License
+ *
+ *  MIT license, all text above must be included in any redistribution
+ */
+
+#pragma once
+#include <BMA400.h>
+
+#define BMA400_WATCHDOG_FIRST BMA400_REG_ACC_CONFIG_0 // first shadowed register
+#define BMA400_WATCHDOG_SIZE 0x40                     // shadowed registers (up to TAP_CONFIG_1)
+
+class BMA400Watchdog
+{
+public:
+    typedef enum // failed checks (combined as flags)
+    {
+        FAULT_NONE = 0x00,
+        FAULT_BUS = 0x01,          // registers could not be read
+        FAULT_DATA_STALLED = 0x02, // no new data for the configured number of checks
+        FAULT_TIME_STALLED = 0x04, // sensor time stopped or running far too slow
+        FAULT_CONFIG = 0x08,       // configuration on the chip differs from the shadow
+        FAULT_SHADOW = 0x10,       // shadow does not match its CRC (corrupted RAM), nothing restored
+    } watchdog_fault_t;
+
+    typedef struct // incident counters
+    {
+        uint32_t checks;       // checks run
+        uint32_t bus;          // checks failed reading the registers
+        uint32_t data_stalled; // data stall incidents
+        uint32_t time_stalled; // sensor time incidents
+        uint32_t config;       // configuration mismatches
+        uint32_t shadow;       // corrupted shadows
+        uint32_t restores;     // configurations written back
+        uint32_t resets;       // soft resets
+        uint32_t registers;    // registers written during recoveries
+    } watchdog_counters_t;
+
+    typedef void (*watchdog_callback_t)(uint8_t faults, void *context);
+
+    bool Begin(BMA400 &sensor, uint32_t interval = 1000, uint8_t stalled_checks = 3);
+    bool Capture();
+    void SetInterval(uint32_t interval);
+    void SetCallback(watchdog_callback_t callback, void *context = nullptr);
+
+    uint8_t Update();
+    uint8_t Check();
+
+    uint8_t GetLastFaults();
+    uint8_t GetShadowCrc();
+    void GetCounters(watchdog_counters_t &counters);
+    void ResetCounters();
+
+private:
+    BMA400 *sensor = nullptr;
+    uint8_t shadow[BMA400_WATCHDOG_SIZE];
+    uint8_t mask[BMA400_WATCHDOG_SIZE]; // compared bits per register
+    uint8_t shadow_crc = 0;
+    bool captured = false;
+
+    uint32_t interval = 1000;
+    uint32_t last_check = 0;
+    uint8_t stalled_checks = 3;
+
+    uint8_t last_data[6];
+    uint32_t last_time = 0;     // sensor time of the last check
+    uint32_t last_progress = 0; // millis() of the last check
+    bool progress_valid = false;
+    uint8_t data_stalls = 0;
+    uint8_t time_stalls = 0;
+    bool escalate = false; // power mode restarted, the next stall resets the chip
+
+    uint8_t last_faults = FAULT_NONE;
+    watchdog_counters_t counters = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    watchdog_callback_t callback = nullptr;
+    void *context = nullptr;
+
+    uint8_t checkProgress(uint32_t now);
+    uint8_t checkConfiguration(uint8_t *chip);
+    bool recover(uint8_t faults, const uint8_t *chip);
+    void restore(const uint8_t *chip);
+    void buildMask();
+    uint8_t crc(const uint8_t *values);
+    static bool isWritable(uint8_t index);
+};